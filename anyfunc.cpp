@@ -1,3 +1,5 @@
+#include <cassert>
+
 #include <iostream>
 
 #include <memory>
@@ -12,6 +14,18 @@ struct S
   }
 };
 
+// counts its copies, moves are free
+struct counted
+{
+  static inline int copies;
+
+  counted() = default;
+
+  counted(counted const&) noexcept { ++copies; }
+
+  counted(counted&&) = default;
+};
+
 int main()
 {
   gnr::anyfunc<> f(
@@ -45,5 +59,64 @@ int main()
 
   f.invoke<void>(std::make_shared<int>(10));
 
+  {
+    // checked calls, a mismatch is reported without calling the target
+    int calls{};
+
+    gnr::anyfunc<gnr::anyfunc<>::size, true> g([&](int const x)
+      {
+        return ++calls, x + 1;
+      }
+    );
+
+    auto const r(g.try_invoke<int>(1));
+    assert(r && (2 == *r) && (1 == calls));
+
+    assert(!g.try_invoke<int>(1.5) && !g.try_invoke<long>(1) &&
+      !g.try_invoke<void>(1) && (1 == calls));
+
+    // a reference result is wrapped
+    int v{};
+
+    g = [&]() -> int& { return v; };
+
+    auto const p(g.try_invoke<int&>());
+    assert(p && (&v == &p->get()));
+
+    p->get() = 5;
+
+    std::cout << *r << ' ' << calls << ' ' << v << std::endl;
+  }
+
+  {
+    counted c;
+
+    // class types are passed as T const&, never copied
+    gnr::anyfunc<gnr::anyfunc<>::size, true, gnr::anyfunc_args::cref> g(
+      [](counted const& x) noexcept { return &x; }
+    );
+
+    auto const p(g.invoke<counted const*>(c));
+    assert((&c == p) && !counted::copies);
+
+    // a by-value handler does not match
+    g = [](counted) noexcept { return true; };
+    assert(!g.try_invoke<bool>(c));
+
+    // arguments keep their value category
+    gnr::anyfunc<gnr::anyfunc<>::size, true, gnr::anyfunc_args::forward> h(
+      [](counted&&) noexcept { return true; }
+    );
+
+    auto const q(h.try_invoke<bool>(std::move(c)));
+    assert(q && !counted::copies);
+
+    // an lvalue is passed as counted&, which the handler does not take
+    assert(!h.try_invoke<bool>(c));
+
+    std::cout << (&c == p) << ' ' << bool(q) << ' ' << counted::copies <<
+      std::endl;
+  }
+
   return 0;
 }
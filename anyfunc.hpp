@@ -7,438 +7,233 @@
 // std::size_t
 #include <cstddef>
 
-#include <any>
+#include <cstdint>
+
+#include <cstdlib>
 
 #include <functional>
 
+#include <optional>
+
+#include <string_view>
+
 #include <tuple>
 
 #include <type_traits>
 
 #include <utility>
 
-namespace gnr
-{
-
-namespace detail
-{
-
-namespace anyfunc
-{
-
-template <typename>
-struct signature
-{
-};
-
-//
-template <typename>
-struct class_ref;
-
-//
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...)>
-{
-  using type = C&;
-};
-
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...) const>
-{
-  using type = C const&;
-};
-
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...) const volatile>
-{
-  using type = C const volatile&;
-};
-
-//
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...) &>
-{
-  using type = C&;
-};
-
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...) const &>
-{
-  using type = C const&;
-};
-
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...) const volatile &>
-{
-  using type = C const volatile&;
-};
+#include "callback.hpp"
 
-//
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...) &&>
-{
-  using type = C&&;
-};
+#include "signature.hpp"
 
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...) const &&>
-{
-  using type = C const&&;
-};
-
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...) const volatile &&>
-{
-  using type = C const volatile&&;
-};
-
-//
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...) noexcept>
-{
-  using type = C&;
-};
-
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...) const noexcept>
-{
-  using type = C const&;
-};
-
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...) const volatile noexcept>
-{
-  using type = C const volatile&;
-};
-
-//
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...) & noexcept>
-{
-  using type = C&;
-};
-
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...) const & noexcept>
-{
-  using type = C const&;
-};
-
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...) const volatile & noexcept>
-{
-  using type = C const volatile&;
-};
-
-//
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...) && noexcept>
-{
-  using type = C&&;
-};
-
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...) const && noexcept>
-{
-  using type = C const &&;
-};
-
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...) const volatile && noexcept>
-{
-  using type = C const volatile &&;
-};
-
-template <typename F>
-using class_ref_t = typename class_ref<F>::type;
-
-//
-template <typename>
-struct remove_cv_seq;
-
-//
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...)>
-{
-  using type = R(A...);
-};
-
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) const>
-{
-  using type = R(A...);
-};
-
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) volatile>
-{
-  using type = R(A...);
-};
-
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) const volatile>
+namespace gnr
 {
-  using type = R(A...);
-};
 
-//
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) const noexcept>
+// how invoke() arguments are matched against the target signature
+enum class anyfunc_args
 {
-  using type = R(A...);
+  value, // decayed copies
+  cref, // class types as T const&, others decayed
+  forward // as forwarded, T& or T&&
 };
 
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) volatile noexcept>
+namespace detail
 {
-  using type = R(A...);
-};
 
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) const volatile noexcept>
+namespace anyfunc
 {
-  using type = R(A...);
-};
 
-//
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) &>
-{
-  using type = R(A...);
-};
+constexpr auto default_size = 4 * sizeof(void*);
 
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) const &>
+// FNV-1a of the pretty function name, which spells out T
+template <typename T>
+constexpr std::uint64_t type_hash() noexcept
 {
-  using type = R(A...);
-};
+#if defined(_MSC_VER)
+  std::string_view const s(__FUNCSIG__);
+#else
+  std::string_view const s(__PRETTY_FUNCTION__);
+#endif // _MSC_VER
 
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) volatile &>
-{
-  using type = R(A...);
-};
+  std::uint64_t h(14695981039346656037ull);
 
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) const volatile &>
-{
-  using type = R(A...);
-};
-
-//
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) & noexcept>
-{
-  using type = R(A...);
-};
+  for (auto const c: s)
+  {
+    h = (h ^ std::uint8_t(c)) * 1099511628211ull;
+  }
 
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) const & noexcept >
-{
-  using type = R(A...);
-};
+  return h;
+}
 
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) volatile & noexcept>
-{
-  using type = R(A...);
-};
+template <typename T>
+constexpr std::uint64_t type_hash_v = type_hash<T>();
 
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) const volatile & noexcept>
+// std::reference_wrapper<T> always becomes T&
+template <anyfunc_args P, typename T, typename = std::decay_t<T>>
+struct arg_type
 {
-  using type = R(A...);
-};
-
-//
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) &&>
-{
-  using type = R(A...);
+  using type = std::conditional_t<anyfunc_args::forward == P,
+    T&&,
+    std::conditional_t<
+      (anyfunc_args::cref == P) && std::is_class<std::decay_t<T>>{},
+      std::decay_t<T> const&,
+      std::decay_t<T>
+    >
+  >;
 };
 
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) const &&>
+template <anyfunc_args P, typename T, typename U>
+struct arg_type<P, T, std::reference_wrapper<U>>
 {
-  using type = R(A...);
+  using type = U&;
 };
 
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) volatile &&>
+template <bool C>
+class checker
 {
-  using type = R(A...);
-};
+  std::uint64_t sig_{};
 
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) const volatile &&>
-{
-  using type = R(A...);
-};
+protected:
+  template <typename T>
+  void set() noexcept
+  {
+    sig_ = type_hash_v<T>;
+  }
 
-//
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) && noexcept>
-{
-  using type = R(A...);
+  template <typename T>
+  bool check() const noexcept
+  {
+    return type_hash_v<T> == sig_;
+  }
 };
 
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) const && noexcept>
-{
-  using type = R(A...);
-};
+// std::optional does not hold references, an lvalue reference result is
+// wrapped, an rvalue reference one is moved from
+template <typename R>
+using optional_t = std::optional<
+  std::conditional_t<std::is_lvalue_reference<R>{},
+    std::reference_wrapper<std::remove_reference_t<R>>,
+    std::remove_cv_t<std::remove_reference_t<R>>
+  >
+>;
 
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) volatile && noexcept>
+#ifdef NDEBUG
+template <>
+class checker<false>
 {
-  using type = R(A...);
-};
+protected:
+  template <typename T>
+  void set() noexcept
+  {
+  }
 
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) const volatile && noexcept>
-{
-  using type = R(A...);
+  template <typename T>
+  constexpr bool check() const noexcept
+  {
+    return true;
+  }
 };
+#endif // NDEBUG
 
-template <typename F>
-constexpr auto extract_signature(F* const) noexcept
-{
-  return signature<typename remove_cv_seq<F>::type>();
 }
 
-template <typename C, typename F>
-constexpr auto extract_signature(F C::* const) noexcept
-{
-  return signature<typename remove_cv_seq<F>::type>();
 }
 
-template <typename F>
-constexpr auto extract_signature(F const&) noexcept ->
-  decltype(&F::operator(), extract_signature(&F::operator()))
+// C enables the signature check in release builds
+template <std::size_t N = detail::anyfunc::default_size, bool C = false,
+  anyfunc_args P = anyfunc_args::value
+>
+class anyfunc :
+  detail::funcstore::func_store<void (*)(), N,
+    detail::funcstore::policy::spill
+  >,
+  detail::anyfunc::checker<C>
 {
-  return extract_signature(&F::operator());
-}
+  using inherited_t = detail::funcstore::func_store<void (*)(), N,
+    detail::funcstore::policy::spill
+  >;
 
-}
-
-}
-
-template <typename Any = std::any>
-class anyfunc
-{
-  using typeid_t = void(*)();
+  using checker_t = detail::anyfunc::checker<C>;
 
-  template <typename T>
-  static typeid_t type_id() noexcept
+  void* store() const noexcept
   {
-    return typeid_t(type_id<T>);
+    return const_cast<void*>(static_cast<void const*>(
+      std::addressof(inherited_t::store_)));
   }
 
-  void (*f_)(Any const&, void const*, void*) {};
-
-  Any any_;
-
-#ifndef NDEBUG
-  typeid_t type_id_;
-#endif // NDEBUG
-
-  template <typename F, typename R, typename ...A>
-  static std::enable_if_t<
-    !std::is_member_function_pointer<F>{} &&
-    !std::is_void<R>{}
-  >
-  invoker(Any const& any, void const* const v, void* const r)
+  [[noreturn]] static void mismatch()
   {
-    *static_cast<R*>(r) = std::apply(std::any_cast<F>(any),
-      *static_cast<std::tuple<A...> const*>(v)
-    );
+#if defined(__cpp_exceptions)
+    throw std::bad_function_call();
+#else
+    std::abort();
+#endif
   }
 
-  template <typename F, typename R, typename ...A>
-  static std::enable_if_t<
-    !std::is_member_function_pointer<F>{} &&
-    std::is_void<R>{}
-  >
-  invoker(Any const& any, void const* const v, void*)
+  template <typename R, typename ...A>
+  void check() const
   {
-    std::apply(std::any_cast<F>(any),
-      *static_cast<std::tuple<A...> const*>(v)
-    );
+    using test_t = std::tuple<R, arg_type_t<A>...>;
+
+    if constexpr (C)
+    {
+      if (!checker_t::template check<test_t>())
+      {
+        mismatch();
+      }
+      // else do nothing
+    }
+    else
+    {
+      assert(checker_t::template check<test_t>());
+    }
   }
 
-  template <typename F, typename R, typename ...A>
-  static std::enable_if_t<
-    std::is_member_function_pointer<F>{} &&
-    !std::is_void<R>{}
-  >
-  invoker(Any const& any, void const* const v, void* const r)
+  // by-value arguments are materialized here, references pass through
+  template <typename R, typename ...A>
+  R call(A&& ...args) const
   {
-    *static_cast<R*>(r) = std::apply(std::any_cast<F>(any),
-      *static_cast<
-        std::tuple<detail::anyfunc::class_ref_t<F>, A...> const*
-      >(v)
-    );
+    return reinterpret_cast<R (*)(void*, arg_type_t<A>&&...)>(
+      inherited_t::f_)(store(),
+        static_cast<arg_type_t<A>>(std::forward<A>(args))...);
   }
 
   template <typename F, typename R, typename ...A>
-  static std::enable_if_t<
-    std::is_member_function_pointer<F>{} &&
-    std::is_void<R>{}
-  >
-  invoker(Any const& any, void const* const v, void*)
+  static R invoker(void* const store, A&& ...args)
   {
-    std::apply(std::any_cast<F>(any),
-      *static_cast<
-        std::tuple<detail::anyfunc::class_ref_t<F>, A...> const*
-      >(v)
-    );
+    return std::invoke(inherited_t::template functor<F>(store),
+      std::forward<A>(args)...);
   }
 
   template <typename F, typename R, typename ...A>
   std::enable_if_t<!std::is_member_function_pointer<F>{}>
-  assign(detail::anyfunc::signature<R(A...)>) noexcept
+  assign(detail::signature<R(A...)>) noexcept
   {
-    f_ = invoker<std::decay_t<F>, R, A...>;
+    inherited_t::f_ = reinterpret_cast<void (*)()>(invoker<F, R, A...>);
 
-#ifndef NDEBUG
-    type_id_ = type_id<std::tuple<R, A...>>();
-#endif // NDEBUG
+    checker_t::template set<std::tuple<R, A...>>();
   }
 
   template <typename F, typename R, typename ...A>
   std::enable_if_t<std::is_member_function_pointer<F>{}>
-  assign(detail::anyfunc::signature<R(A...)>) noexcept
+  assign(detail::signature<R(A...)>) noexcept
   {
-    f_ = invoker<F, R, A...>;
+    inherited_t::f_ = reinterpret_cast<void (*)()>(
+      invoker<F, R, detail::class_ref_t<F>, A...>);
 
-#ifndef NDEBUG
-    type_id_ = type_id<
-      std::tuple<R, detail::anyfunc::class_ref_t<F>, A...>
+    checker_t::template set<
+      std::tuple<R, detail::class_ref_t<F>, A...>
     >();
-#endif // NDEBUG
   }
 
 public:
-  template <typename T, typename = std::void_t<>>
-  struct arg_type
-  {
-    using type = std::decay_t<T>;
-  };
-
-  /*
-  template <typename T>
-  struct arg_type<T,
-    std::void_t<std::enable_if_t<std::is_class_v<std::decay_t<T>>>>
-  >
-  {
-    using type = T const&;
-  };
-  */
+  enum : std::size_t { size = N };
 
+public:
   template <typename T>
-  struct arg_type<std::reference_wrapper<T>>
+  struct arg_type : detail::anyfunc::arg_type<P, T>
   {
-    using type = T&;
   };
 
   template <typename T>
@@ -451,10 +246,9 @@ public:
       !std::is_same<std::decay_t<F>, anyfunc>{}
     >
   >
-  anyfunc(F&& f) :
-    any_(std::forward<F>(f))
+  anyfunc(F&& f)
   {
-    assign<F>(detail::anyfunc::extract_signature(std::forward<F>(f)));
+    assign(std::forward<F>(f));
   }
 
   anyfunc(anyfunc const&) = default;
@@ -479,7 +273,7 @@ public:
 
   bool operator==(std::nullptr_t) const noexcept
   {
-    return f_;
+    return inherited_t::f_;
   }
 
   bool operator!=(std::nullptr_t) const noexcept
@@ -489,31 +283,13 @@ public:
 
   explicit operator bool() const noexcept
   {
-    return f_;
-  }
-
-  template <typename R, typename ...A>
-  std::enable_if_t<!std::is_void<R>{}, R>
-  operator()(A&&... args) const noexcept(
-    noexcept(std::declval<anyfunc>().template invoke<R>(
-        std::forward<A>(args)...
-      )
-    )
-  )
-  {
-    return invoke<R>(std::forward<A>(args)...);
+    return inherited_t::f_;
   }
 
   template <typename R = void, typename ...A>
-  std::enable_if_t<std::is_void<R>{}, R>
-  operator()(A&&... args) const noexcept(
-    noexcept(std::declval<anyfunc>().template invoke<R>(
-        std::forward<A>(args)...
-      )
-    )
-  )
+  R operator()(A&&... args) const
   {
-    invoke<R>(std::forward<A>(args)...);
+    return invoke<R>(std::forward<A>(args)...);
   }
 
   void assign(std::nullptr_t) noexcept
@@ -524,9 +300,13 @@ public:
   template <typename F>
   void assign(F&& f)
   {
-    any_ = std::forward<F>(f);
+    using functor_type = std::decay_t<F>;
+    static_assert(std::is_copy_constructible<functor_type>{},
+      "functor not copy constructible");
+
+    inherited_t::template emplace<functor_type>(std::forward<F>(f));
 
-    assign<F>(detail::anyfunc::extract_signature(std::forward<F>(f)));
+    assign<functor_type>(detail::extract_signature(f));
   }
 
   bool empty() const noexcept
@@ -536,44 +316,56 @@ public:
 
   bool has_value() const noexcept
   {
-    return *this;
+    return bool(*this);
   }
 
-  template <typename R, typename ...A>
-  std::enable_if_t<!std::is_void<R>{}, R>
-  invoke(A... args) const noexcept(noexcept(f_(any_, {}, {})))
+  template <typename R = void, typename ...A>
+  R invoke(A&& ...args) const
   {
-    assert(f_);
-#ifndef NDEBUG
-    using test_t = std::tuple<R, arg_type_t<A>...>;
-    assert(type_id<test_t>() == type_id_);
-#endif // NDEBUG
-
-    R r;
+    assert(inherited_t::f_);
+    check<R, A...>();
 
-    std::tuple<arg_type_t<A>...> const a{std::forward<A>(args)...};
+    return call<R>(std::forward<A>(args)...);
+  }
 
-    f_(any_, &a, &r);
+  // empty on a signature mismatch or if there is no target
+  template <typename R, typename ...A>
+  std::enable_if_t<!std::is_void<R>{}, detail::anyfunc::optional_t<R>>
+  try_invoke(A&& ...args) const
+  {
+    static_assert(C, "try_invoke requires the checked mode");
+    using test_t = std::tuple<R, arg_type_t<A>...>;
 
-    return r;
+    if (inherited_t::f_ && checker_t::template check<test_t>())
+    {
+      return call<R>(std::forward<A>(args)...);
+    }
+    else
+    {
+      return {};
+    }
   }
 
   template <typename R = void, typename ...A>
-  std::enable_if_t<std::is_void<R>{}, R>
-  invoke(A... args) const noexcept(noexcept(f_(any_, {}, {})))
+  std::enable_if_t<std::is_void<R>{}, bool>
+  try_invoke(A&& ...args) const
   {
-    assert(f_);
-#ifndef NDEBUG
+    static_assert(C, "try_invoke requires the checked mode");
     using test_t = std::tuple<R, arg_type_t<A>...>;
-    assert(type_id<test_t>() == type_id_);
-#endif // NDEBUG
 
-    std::tuple<arg_type_t<A>...> const a{std::forward<A>(args)...};
+    if (inherited_t::f_ && checker_t::template check<test_t>())
+    {
+      call<R>(std::forward<A>(args)...);
 
-    f_(any_, &a, {});
+      return true;
+    }
+    else
+    {
+      return false;
+    }
   }
 
-  void reset() noexcept { f_ = {}; }
+  void reset() noexcept { inherited_t::clear(); }
 
   void swap(anyfunc& other) noexcept
   {
@@ -0,0 +1,119 @@
+// g++ -std=c++17 anyfuncregistry.cpp -o anyfuncregistry
+#include <cassert>
+
+// std::size_t
+#include <cstddef>
+
+#include <iostream>
+
+#include <stdexcept>
+
+#include <string>
+
+#include <vector>
+
+#include "anyfuncregistry.hpp"
+
+int main()
+{
+  gnr::anyfunc_registry<> r;
+
+  int total{};
+
+  auto const add(r.add("add", [&](int const x) { total += x; }));
+  auto const sub(r.add("sub", [&](int const x) { total -= x; }));
+  r.add("get", [&]() { return total; });
+
+  for (int i{}; i != 100; ++i)
+  {
+    r.add("handler" + std::to_string(i), [i]() { return i; });
+  }
+
+  assert(!r.frozen() && (add == r.find("add")));
+
+  r.freeze();
+  assert(r.frozen());
+
+  // every name resolves to its id through the perfect hash
+  for (decltype(r)::id_type i{}; i != r.size(); ++i)
+  {
+    assert(i == r.find(r.name(i)));
+  }
+
+  // names, that were never added, miss
+  assert((decltype(r)::npos == r.find("mul")) &&
+    (decltype(r)::npos == r.find("handler100")) &&
+    (decltype(r)::npos == r.find("")));
+
+  r.invoke("add", 5);
+  r.invoke(sub, 2);
+
+  assert((3 == r.invoke<int>("get")) && (42 == r.invoke<int>("handler42")));
+
+  std::cout << r.name(add) << ' ' << r.find("sub") << ' ' <<
+    r.invoke<int>("get") << ' ' << r.invoke<int>("handler42") << std::endl;
+
+#if defined(__cpp_exceptions)
+  try
+  {
+    r.invoke("mul", 2);
+
+    assert(false);
+  }
+  catch (std::out_of_range const& e)
+  {
+    std::cout << "not found: " << e.what() << std::endl;
+  }
+#endif
+
+  // a new name thaws the registry, lookups fall back to the index
+  auto const mul(r.add("mul", [&](int const x) { total *= x; }));
+  assert(!r.frozen() && (mul == r.find("mul")));
+
+  r.freeze();
+  assert(mul == r.find("mul"));
+
+  r.invoke(mul, 2);
+  assert(6 == r.invoke<int>("get"));
+
+  std::cout << r.name(mul) << ": " << r.size() << " handlers, total " <<
+    total << std::endl;
+
+  // sets with names, that collide in the low bits of FNV-1a
+  std::vector<std::vector<std::string>> const sets{
+    {"on", "off"},
+    {"start", "stop"},
+    {"a", "e"},
+    {"ab", "cb"},
+    {"open", "close", "read", "write"},
+    {"get", "set", "put", "del", "add", "sub", "mul"},
+    {"w", "x", "y", "z", "ww", "xx", "yy", "zz"}
+  };
+
+  std::size_t found{};
+
+  for (auto& names: sets)
+  {
+    gnr::anyfunc_registry<> s;
+
+    for (auto& name: names)
+    {
+      s.add(name, [&name]() { return name.size(); });
+    }
+
+    s.freeze();
+
+    for (auto& name: names)
+    {
+      found += (name == s.name(s.find(name))) &&
+        (name.size() == s.invoke<std::size_t>(name));
+    }
+  }
+
+  assert(27 == found);
+
+  std::cout << sets.size() << " name sets frozen, " << found << " found" <<
+    std::endl;
+
+  return 0;
+}
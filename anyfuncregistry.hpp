@@ -0,0 +1,325 @@
+#ifndef GNR_ANYFUNCREGISTRY_HPP
+# define GNR_ANYFUNCREGISTRY_HPP
+# pragma once
+
+#include <cassert>
+
+// std::size_t
+#include <cstddef>
+
+#include <cstdint>
+
+#include <algorithm>
+
+#include <stdexcept>
+
+#include <string>
+
+#include <string_view>
+
+#include <unordered_map>
+
+#include <utility>
+
+#include <vector>
+
+#include "anyfunc.hpp"
+
+namespace gnr
+{
+
+namespace detail::anyfunc_registry
+{
+
+constexpr std::uint64_t hash(std::uint64_t const d,
+  std::string_view const s) noexcept
+{
+  std::uint64_t h(14695981039346656037ull ^ (d * 11400714819323198485ull));
+
+  for (auto const c: s)
+  {
+    h = (h ^ std::uint8_t(c)) * 1099511628211ull;
+  }
+
+  // the low bits of FNV-1a only depend on the low bits of the seed, the
+  // murmur3 finalizer spreads the seed d over all the bits that are masked
+  h = (h ^ (h >> 33)) * 0xff51afd7ed558ccdull;
+  h = (h ^ (h >> 33)) * 0xc4ceb9fe1a85ec53ull;
+
+  return h ^ (h >> 33);
+}
+
+}
+
+// handlers are kept in a flat array and addressed by dense ids, names are
+// resolved through a perfect hash once the registry is frozen
+template <typename F = anyfunc<>>
+class anyfunc_registry
+{
+public:
+  using id_type = std::uint32_t;
+
+  using size_type = std::size_t;
+
+  using value_type = F;
+
+  static constexpr auto const npos = ~id_type{};
+
+private:
+  // displacements tried per bucket, before the table is grown
+  enum : std::int32_t { max_disp = 1 << 12 };
+
+  std::vector<F> f_;
+
+  std::vector<std::string> names_;
+
+  std::unordered_map<std::string, id_type> index_;
+
+  // displacements per bucket, negative ones encode a slot directly
+  std::vector<std::int32_t> disp_;
+
+  std::vector<id_type> slots_;
+
+  id_type slot(std::string_view const name) const noexcept
+  {
+    using detail::anyfunc_registry::hash;
+
+    auto const mask(slots_.size() - 1);
+
+    auto const d(disp_[hash(0, name) & mask]);
+
+    return slots_[d < 0 ? -d - 1 : hash(d, name) & mask];
+  }
+
+  // builds the perfect hash over m slots, false if some bucket could not
+  // be placed within the allowed displacements
+  bool place(size_type const m)
+  {
+    using detail::anyfunc_registry::hash;
+
+    auto const n(names_.size());
+
+    disp_.assign(m, 0);
+    slots_.assign(m, npos);
+
+    auto const mask(m - 1);
+
+    std::vector<std::vector<id_type>> buckets(m);
+
+    for (id_type i{}; i != n; ++i)
+    {
+      buckets[hash(0, names_[i]) & mask].push_back(i);
+    }
+
+    // place the largest buckets first
+    std::vector<size_type> order(m);
+
+    for (size_type i{}; i != m; ++i)
+    {
+      order[i] = i;
+    }
+
+    std::stable_sort(order.begin(), order.end(),
+      [&](auto const a, auto const b) noexcept
+      {
+        return buckets[a].size() > buckets[b].size();
+      }
+    );
+
+    auto o(order.cbegin());
+
+    std::vector<size_type> placed;
+
+    for (; (order.cend() != o) && (buckets[*o].size() > 1); ++o)
+    {
+      auto& bucket(buckets[*o]);
+
+      for (std::int32_t d(1);; ++d)
+      {
+        if (max_disp == d)
+        {
+          return false;
+        }
+        // else do nothing
+
+        placed.clear();
+
+        for (auto const i: bucket)
+        {
+          auto const s(hash(d, names_[i]) & mask);
+
+          if ((npos != slots_[s]) ||
+            (placed.end() != std::find(placed.begin(), placed.end(), s)))
+          {
+            break;
+          }
+          else
+          {
+            placed.push_back(s);
+          }
+        }
+
+        if (placed.size() == bucket.size())
+        {
+          for (size_type j{}; j != bucket.size(); ++j)
+          {
+            slots_[placed[j]] = bucket[j];
+          }
+
+          disp_[*o] = d;
+
+          break;
+        }
+        // else do nothing
+      }
+    }
+
+    // single names go straight into the remaining free slots
+    size_type s{};
+
+    for (; (order.cend() != o) && (1 == buckets[*o].size()); ++o)
+    {
+      while (npos != slots_[s])
+      {
+        ++s;
+      }
+
+      slots_[s] = buckets[*o].front();
+
+      disp_[*o] = -std::int32_t(s) - 1;
+    }
+
+    return true;
+  }
+
+public:
+  anyfunc_registry() = default;
+
+  anyfunc_registry(anyfunc_registry const&) = default;
+
+  anyfunc_registry(anyfunc_registry&&) = default;
+
+  anyfunc_registry& operator=(anyfunc_registry const&) = default;
+
+  anyfunc_registry& operator=(anyfunc_registry&&) = default;
+
+  F& operator[](id_type const i) noexcept
+  {
+    assert(i < f_.size());
+    return f_[i];
+  }
+
+  F const& operator[](id_type const i) const noexcept
+  {
+    assert(i < f_.size());
+    return f_[i];
+  }
+
+  // registering a name again replaces its handler and keeps its id
+  template <typename G>
+  id_type add(std::string name, G&& g)
+  {
+    if (auto const i(index_.find(name)); index_.end() == i)
+    {
+      auto const id(id_type(f_.size()));
+
+      f_.emplace_back(std::forward<G>(g));
+      names_.push_back(name);
+
+      index_.emplace(std::move(name), id);
+
+      // a new name invalidates the perfect hash
+      disp_.clear();
+      slots_.clear();
+
+      return id;
+    }
+    else
+    {
+      f_[i->second] = std::forward<G>(g);
+
+      return i->second;
+    }
+  }
+
+  id_type find(std::string_view const name) const
+  {
+    if (frozen())
+    {
+      auto const id(slot(name));
+
+      return (npos != id) && (names_[id] == name) ? id : npos;
+    }
+    else
+    {
+      auto const i(index_.find(std::string(name)));
+
+      return index_.end() == i ? npos : i->second;
+    }
+  }
+
+  void freeze()
+  {
+    // a power of two, large enough for all names, doubled on failure
+    size_type m(1);
+
+    while (m < names_.size())
+    {
+      m <<= 1;
+    }
+
+    while (!place(m))
+    {
+      m <<= 1;
+    }
+  }
+
+  bool frozen() const noexcept
+  {
+    return !slots_.empty();
+  }
+
+  template <typename R = void, typename ...A>
+  R invoke(id_type const i, A&& ...args) const
+  {
+    assert(i < f_.size());
+    return f_[i].template invoke<R>(std::forward<A>(args)...);
+  }
+
+  template <typename R = void, typename ...A>
+  R invoke(std::string_view const name, A&& ...args) const
+  {
+    auto const i(find(name));
+
+#if defined(__cpp_exceptions)
+    if (npos == i)
+    {
+      throw std::out_of_range(std::string(name));
+    }
+    // else do nothing
+#endif
+
+    return invoke<R>(i, std::forward<A>(args)...);
+  }
+
+  std::string_view name(id_type const i) const noexcept
+  {
+    assert(i < names_.size());
+    return names_[i];
+  }
+
+  bool empty() const noexcept { return f_.empty(); }
+
+  size_type size() const noexcept { return f_.size(); }
+
+  void reserve(size_type const n)
+  {
+    f_.reserve(n);
+    names_.reserve(n);
+    index_.reserve(n);
+  }
+};
+
+}
+
+#endif // GNR_ANYFUNCREGISTRY_HPP
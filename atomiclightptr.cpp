@@ -0,0 +1,233 @@
+// g++ -std=c++17 -O2 -pthread atomiclightptr.cpp -o atomiclightptr
+#include <cassert>
+
+#include <cstdlib>
+
+#include <algorithm>
+
+#include <atomic>
+
+#include <chrono>
+
+#include <iostream>
+
+#include <mutex>
+
+#include <thread>
+
+#include <vector>
+
+#include "atomiclightptr.hpp"
+
+struct config
+{
+  static inline std::atomic<int> live;
+
+  int a, b;
+
+  explicit config(int const v) noexcept : a(v), b(-v) { ++live; }
+
+  ~config() { a = b = 0; --live; }
+};
+
+// a light_ptr behind a mutex, for comparison
+struct locked_light_ptr
+{
+  mutable std::mutex m;
+
+  gnr::light_ptr<config> p;
+
+  auto load() const
+  {
+    std::lock_guard<std::mutex> l(m);
+
+    return p;
+  }
+
+  void store(gnr::light_ptr<config> q)
+  {
+    std::lock_guard<std::mutex> l(m);
+
+    p.swap(q);
+  }
+};
+
+// one writer publishes new snapshots, while the readers check them
+template <typename P>
+void run(char const* const name, P& p, unsigned const readers)
+{
+  std::atomic<bool> done{};
+  std::atomic<unsigned long> loads{};
+
+  std::vector<std::thread> t;
+
+  for (unsigned i{}; i != readers; ++i)
+  {
+    t.emplace_back([&]
+      {
+        unsigned long n{};
+
+        while (!done.load(std::memory_order_relaxed))
+        {
+          auto const c(p.load());
+
+          if (c->a != -c->b)
+          {
+            std::cerr << "torn snapshot" << std::endl;
+
+            std::abort();
+          }
+          // else do nothing
+
+          ++n;
+        }
+
+        loads += n;
+      }
+    );
+  }
+
+  auto const start(std::chrono::steady_clock::now());
+
+  for (int i{}; i != 200000; ++i)
+  {
+    p.store(gnr::make_light<config>(i + 1));
+  }
+
+  done = true;
+
+  for (auto& th: t)
+  {
+    th.join();
+  }
+
+  auto const s(std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - start).count());
+
+  std::cout << name << ": " << readers << " readers, " <<
+    loads / s / 1e6 << " Mloads/s" << std::endl;
+}
+
+// the writers race to increment the value, a lost race updates the
+// expected value and retries, while the readers check every snapshot
+void cas(gnr::atomic_light_ptr<config>& p, unsigned const writers,
+  int const n)
+{
+  auto const start(p.load()->a);
+
+  std::atomic<bool> done{};
+  std::atomic<unsigned long> retries{};
+
+  std::thread reader([&]
+    {
+      while (!done.load(std::memory_order_relaxed))
+      {
+        auto const c(p.load());
+
+        if (c->a != -c->b)
+        {
+          std::cerr << "torn snapshot" << std::endl;
+
+          std::abort();
+        }
+        // else do nothing
+      }
+    }
+  );
+
+  std::vector<std::thread> t;
+
+  for (unsigned i{}; i != writers; ++i)
+  {
+    t.emplace_back([&]
+      {
+        unsigned long r{};
+
+        auto e(p.load());
+
+        for (int j{}; j != n; ++j)
+        {
+          for (;;)
+          {
+            auto const d(gnr::make_light<config>(e->a + 1));
+
+            if (p.compare_exchange_strong(e, d))
+            {
+              e = d;
+
+              break;
+            }
+            else
+            {
+              ++r;
+            }
+          }
+        }
+
+        retries += r;
+      }
+    );
+  }
+
+  for (auto& th: t)
+  {
+    th.join();
+  }
+
+  done = true;
+
+  reader.join();
+
+  auto const a(p.load()->a);
+
+  std::cout << "compare_exchange_strong: " << writers << " writers, " <<
+    a - start << " increments, " << retries << " retries" << std::endl;
+
+  if (a - start != int(writers) * n)
+  {
+    std::cerr << "lost increment" << std::endl;
+
+    std::abort();
+  }
+  // else do nothing
+}
+
+int main(int const argc, char* argv[])
+{
+  auto const n(argc > 1 ? unsigned(std::atoi(argv[1])) :
+    std::max(2u, std::thread::hardware_concurrency()) - 1);
+
+  {
+    gnr::atomic_light_ptr<config> p(gnr::make_light<config>(0));
+
+    std::cout << "lock free: " << p.is_lock_free() << std::endl;
+
+    run("atomic_light_ptr", p, n);
+
+    auto e(p.load());
+
+    // fails, e is a copy of another value than the stored one
+    auto const f(p.compare_exchange_strong(e = gnr::make_light<config>(1),
+      gnr::make_light<config>(2)));
+
+    // succeeds, e was updated
+    auto const g(p.compare_exchange_strong(e, gnr::make_light<config>(3)));
+
+    std::cout << f << ' ' << g << ' ' << p.load()->a << std::endl;
+
+    cas(p, std::max(2u, n), 20000);
+  }
+
+  {
+    locked_light_ptr p{{}, gnr::make_light<config>(0)};
+
+    run("mutex", p, n);
+  }
+
+  std::cout << "live: " << config::live << std::endl;
+
+  // a leaked box would keep its config alive
+  assert(!config::live);
+
+  return 0;
+}
@@ -0,0 +1,260 @@
+#ifndef GNR_ATOMICLIGHTPTR_HPP
+# define GNR_ATOMICLIGHTPTR_HPP
+# pragma once
+
+#include <atomic>
+
+// std::uintptr_t
+#include <cstdint>
+
+// std::abort
+#include <cstdlib>
+
+#include <utility>
+
+#include "lightptr.hpp"
+
+// the count of loads in progress is kept in the upper 16 bits of a box
+// address, which requires these bits to be 0 in every user space pointer;
+// this holds for x86-64 with 4-level paging and for aarch64 with 48-bit
+// virtual addresses, as long as no tags are placed in the top byte
+#if !defined(__x86_64__) && !defined(_M_X64) && \
+  !defined(__aarch64__) && !defined(_M_ARM64)
+# error "atomic_light_ptr: unsupported target"
+#elif defined(__ARM_FEATURE_MEMORY_TAGGING)
+# error "atomic_light_ptr: tagged pointers are not supported"
+#elif defined(__has_feature)
+# if __has_feature(hwaddress_sanitizer)
+#  error "atomic_light_ptr: tagged pointers are not supported"
+# endif
+#endif
+
+namespace gnr
+{
+
+// a light_ptr, that may be loaded and stored concurrently without locks;
+// the value lives in a box, whose address shares a word with the count of
+// loads in progress (split reference counting), a store swaps the box and
+// hands that count over to the box, the last one out deletes the box
+template <typename T>
+class atomic_light_ptr
+{
+  static_assert(sizeof(void*) == 8, "64-bit pointers required");
+
+  struct box
+  {
+    // loads to finish, may drop below 0 until the box is swapped out
+    std::atomic<long> pending{};
+
+    light_ptr<T> const p;
+
+    explicit box(light_ptr<T>&& p) noexcept : p(std::move(p)) { }
+
+    void release(long const n) noexcept
+    {
+      if (!(pending.fetch_add(n, std::memory_order_acq_rel) + n))
+      {
+        delete this;
+      }
+      // else do nothing
+    }
+  };
+
+  // the upper 16 bits of a user space address are unused, see above
+  enum : unsigned { shift = 48 };
+
+  static constexpr auto const one = std::uintptr_t(1) << shift;
+  static constexpr auto const mask = one - 1;
+
+  mutable std::atomic<std::uintptr_t> w_;
+
+  static auto get(std::uintptr_t const w) noexcept
+  {
+    return reinterpret_cast<box*>(w & mask);
+  }
+
+  static auto count(std::uintptr_t const w) noexcept
+  {
+    return long(w >> shift);
+  }
+
+  static std::uintptr_t make(light_ptr<T>&& p)
+  {
+    if (p)
+    {
+      auto const b(new box(std::move(p)));
+
+      auto const w(reinterpret_cast<std::uintptr_t>(b));
+
+      // a tagged address or one above 2^48 (5-level paging) would be
+      // corrupted by the count
+      if (w & ~mask)
+      {
+        std::abort();
+      }
+      // else do nothing
+
+      return w;
+    }
+    else
+    {
+      return 0;
+    }
+  }
+
+  // a swapped out box is deleted, after its pending loads are done
+  static void retire(std::uintptr_t const w) noexcept
+  {
+    if (auto const b(get(w)); b)
+    {
+      b->release(count(w));
+    }
+    // else do nothing
+  }
+
+  // the box of the word is kept alive until unpin(), an empty word is never
+  // pinned, as its count could not be told apart from that of a later one
+  box* pin() const noexcept
+  {
+    for (auto w(w_.load(std::memory_order_relaxed)); get(w);)
+    {
+      if (w_.compare_exchange_weak(w, w + one, std::memory_order_acquire,
+        std::memory_order_relaxed))
+      {
+        return get(w);
+      }
+      // else do nothing
+    }
+
+    return nullptr;
+  }
+
+  void unpin(box* const b) const noexcept
+  {
+    if (!b)
+    {
+      return;
+    }
+    // else do nothing
+
+    for (auto w(w_.load(std::memory_order_relaxed)); get(w) == b;)
+    {
+      if (w_.compare_exchange_weak(w, w - one, std::memory_order_release,
+        std::memory_order_relaxed))
+      {
+        return;
+      }
+      // else do nothing
+    }
+
+    // swapped out meanwhile, our load was handed over to the box
+    b->release(-1);
+  }
+
+public:
+  atomic_light_ptr() noexcept : w_{} { }
+
+  atomic_light_ptr(light_ptr<T> p) : w_(make(std::move(p))) { }
+
+  atomic_light_ptr(atomic_light_ptr const&) = delete;
+
+  ~atomic_light_ptr() noexcept { retire(w_.load(std::memory_order_acquire)); }
+
+  atomic_light_ptr& operator=(atomic_light_ptr const&) = delete;
+
+  atomic_light_ptr& operator=(light_ptr<T> p)
+  {
+    return store(std::move(p)), *this;
+  }
+
+  operator light_ptr<T>() const noexcept { return load(); }
+
+  bool is_lock_free() const noexcept { return w_.is_lock_free(); }
+
+  light_ptr<T> load() const noexcept
+  {
+    auto const b(pin());
+
+    auto r(b ? b->p : light_ptr<T>());
+
+    return unpin(b), r;
+  }
+
+  void store(light_ptr<T> p)
+  {
+    retire(w_.exchange(make(std::move(p)), std::memory_order_acq_rel));
+  }
+
+  light_ptr<T> exchange(light_ptr<T> p)
+  {
+    auto const w(w_.exchange(make(std::move(p)), std::memory_order_acq_rel));
+
+    auto const b(get(w));
+
+    auto r(b ? b->p : light_ptr<T>());
+
+    return retire(w), r;
+  }
+
+  // as for std::atomic<std::shared_ptr<T>>, the values are equal if they
+  // share ownership, on failure expected is updated
+  bool compare_exchange_strong(light_ptr<T>& expected, light_ptr<T> desired)
+  {
+    std::uintptr_t n{};
+
+    for (bool made{};;)
+    {
+      auto const b(pin());
+
+      if (b ? b->p != expected : bool(expected))
+      {
+        expected = b ? b->p : light_ptr<T>();
+
+        unpin(b);
+        retire(n);
+
+        return false;
+      }
+      else if (!made)
+      {
+        // do not allocate while pinned
+        unpin(b);
+
+        n = make(std::move(desired));
+        made = true;
+
+        continue;
+      }
+      // else do nothing
+
+      for (auto w(w_.load(std::memory_order_relaxed)); get(w) == b;)
+      {
+        if (w_.compare_exchange_weak(w, n, std::memory_order_acq_rel,
+          std::memory_order_relaxed))
+        {
+          // our own pin goes with the box
+          if (b)
+          {
+            b->release(count(w) - 1);
+          }
+          // else do nothing
+
+          return true;
+        }
+        // else do nothing
+      }
+
+      // swapped meanwhile, compare again
+      unpin(b);
+    }
+  }
+
+  bool compare_exchange_weak(light_ptr<T>& expected, light_ptr<T> desired)
+  {
+    return compare_exchange_strong(expected, std::move(desired));
+  }
+};
+
+}
+
+#endif // GNR_ATOMICLIGHTPTR_HPP
@@ -0,0 +1,615 @@
+// g++ -std=c++17 -O2 -DNDEBUG bench.cpp -o bench && ./bench > bench.json
+#include <algorithm>
+
+#include <any>
+
+#include <array>
+
+#include <chrono>
+
+#include <cstddef>
+
+#include <functional>
+
+#include <iostream>
+
+#include <memory>
+
+#include <random>
+
+#include <string>
+
+#include <tuple>
+
+#include <type_traits>
+
+#include <utility>
+
+#include <vector>
+
+#include "anyfunc.hpp"
+
+#include "callback.hpp"
+
+#include "callbacklist.hpp"
+
+#include "forwarder.hpp"
+
+#include "fwdref.hpp"
+
+#include "memfun.hpp"
+
+#include "some.hpp"
+
+#include "somevector.hpp"
+
+namespace
+{
+
+constexpr std::size_t invoke_n = 50000000;
+constexpr std::size_t object_n = 5000000;
+
+struct result
+{
+  std::string wrapper;
+  std::string kind;
+  std::string op;
+  double value;
+};
+
+std::vector<result> results;
+
+// keeps the optimizer from seeing through t
+template <typename T>
+inline void escape(T& t) noexcept
+{
+#if defined(__GNUC__)
+  asm volatile("" : : "r"(&t) : "memory");
+#else
+  static void* volatile p;
+  p = &t;
+#endif
+}
+
+// nanoseconds per iteration
+template <typename G>
+double measure(std::size_t const n, G&& g)
+{
+  auto const start(std::chrono::steady_clock::now());
+
+  for (std::size_t i{}; i != n; ++i)
+  {
+    g(i);
+  }
+
+  return std::chrono::duration<double, std::nano>(
+    std::chrono::steady_clock::now() - start).count() / n;
+}
+
+template <typename W, typename F, typename C>
+void run(char const* const wrapper, char const* const kind, F const& f,
+  C const call)
+{
+  results.push_back({wrapper, kind, "sizeof", double(sizeof(W))});
+
+  {
+    W w(f);
+    escape(w);
+
+    int sink{};
+
+    results.push_back({wrapper, kind, "invoke",
+      measure(invoke_n, [&](auto const i) { sink += call(w, int(i)); })});
+
+    escape(sink);
+  }
+
+  results.push_back({wrapper, kind, "construct",
+    measure(object_n, [&](auto) { W w(f); escape(w); })});
+
+  {
+    W w(f);
+    escape(w);
+
+    results.push_back({wrapper, kind, "copy",
+      measure(object_n, [&](auto) { W c(w); escape(c); })});
+  }
+
+  {
+    W a(f), b(f);
+
+    results.push_back({wrapper, kind, "move",
+      measure(object_n, [&](auto)
+        {
+          a = std::move(b);
+          escape(a);
+          b = std::move(a);
+          escape(b);
+        }) / 2});
+  }
+}
+
+// copy and visit of a vector of int, double and std::string values
+template <typename S, typename V>
+void run_some(char const* const wrapper, V const visit)
+{
+  std::vector<S> v;
+
+  for (std::size_t i{}; i != 1024; ++i)
+  {
+    switch (i % 3)
+    {
+      case 0:
+        v.emplace_back(int(i));
+        break;
+
+      case 1:
+        v.emplace_back(double(i));
+        break;
+
+      default:
+        v.emplace_back(std::string(i % 32, 'x'));
+    }
+  }
+
+  escape(v);
+
+  results.push_back({wrapper, "some", "sizeof", double(sizeof(S))});
+
+  results.push_back({wrapper, "some", "copy",
+    measure(object_n / v.size(), [&](auto)
+      {
+        auto c(v);
+        escape(c);
+      }) / v.size()});
+
+  {
+    std::mt19937 g;
+
+    results.push_back({wrapper, "some", "shuffle",
+      measure(object_n / v.size(), [&](auto)
+        {
+          std::shuffle(v.begin(), v.end(), g);
+          escape(v);
+        }) / v.size()});
+  }
+
+  double sink{};
+
+  results.push_back({wrapper, "some", "visit",
+    measure(invoke_n / v.size(), [&](auto)
+      {
+        for (auto& e: v)
+        {
+          sink += visit(e);
+        }
+      }) / v.size()});
+
+  escape(sink);
+}
+
+// the same values as run_some, grouped by type
+void run_some_vector()
+{
+  gnr::some_vector v;
+
+  for (std::size_t i{}; i != 1024; ++i)
+  {
+    switch (i % 3)
+    {
+      case 0:
+        v.push_back(int(i));
+        break;
+
+      case 1:
+        v.push_back(double(i));
+        break;
+
+      default:
+        v.push_back(std::string(i % 32, 'x'));
+    }
+  }
+
+  escape(v);
+
+  auto const wrapper("gnr::some_vector");
+
+  results.push_back({wrapper, "some", "copy",
+    measure(object_n / v.size(), [&](auto)
+      {
+        auto c(v);
+        escape(c);
+      }) / v.size()});
+
+  double sink{};
+
+  results.push_back({wrapper, "some", "visit",
+    measure(invoke_n / v.size(), [&](auto)
+      {
+        v.visit(gnr::overloaded{
+            [&](int const e) { sink += e; },
+            [&](double const e) { sink += e; },
+            [&](std::string const& e) { sink += e.size(); }
+          }
+        );
+      }) / v.size()});
+
+  escape(sink);
+}
+
+// n subscribers of four kinds, interleaved
+template <typename C>
+void subscribe(C& c, std::size_t const n, int* const p)
+{
+  for (std::size_t i{}; i != n; ++i)
+  {
+    switch (i % 4)
+    {
+      case 0:
+        c.push_back([p](int const x) noexcept { *p += x; });
+        break;
+
+      case 1:
+        c.push_back([p](int const x) noexcept { *p -= x; });
+        break;
+
+      case 2:
+        c.push_back([p](int const x) noexcept { *p ^= x; });
+        break;
+
+      default:
+        c.push_back([p](int const x) noexcept { *p |= x; });
+    }
+  }
+}
+
+// nanoseconds per subscriber, when all n are fired
+void run_list(std::size_t const n)
+{
+  auto const kind(std::to_string(n) + " subscribers");
+
+  auto const rounds(invoke_n / n);
+
+  int sink{};
+
+  {
+    gnr::callback_list<> l;
+    subscribe(l, n, &sink);
+    escape(l);
+
+    results.push_back({"gnr::callback_list", kind, "invoke",
+      measure(rounds, [&](auto const i) { l.invoke_all(int(i)); }) / n});
+  }
+
+  {
+    std::vector<gnr::callback<>> v;
+    subscribe(v, n, &sink);
+    escape(v);
+
+    results.push_back({"gnr::invoke_all", kind, "invoke",
+      measure(rounds, [&](auto const i) { gnr::invoke_all(v, int(i)); }) /
+        n});
+
+    results.push_back({"std::vector<gnr::callback>", kind, "invoke",
+      measure(rounds, [&](auto const i)
+        {
+          for (auto& c: v)
+          {
+            c.invoke<void>(int(i));
+          }
+        }) / n});
+  }
+
+  {
+    std::vector<std::function<void(int)>> v;
+    subscribe(v, n, &sink);
+    escape(v);
+
+    results.push_back({"std::vector<std::function>", kind, "invoke",
+      measure(rounds, [&](auto const i)
+        {
+          for (auto& f: v)
+          {
+            f(int(i));
+          }
+        }) / n});
+  }
+
+  escape(sink);
+}
+
+// the tuple based invocation of the former gnr::callback, the arguments
+// are packed into a tuple and the result is returned through a pointer
+template <std::size_t N = gnr::callback<>::size>
+class tuple_callback
+{
+  void (*f_)(void*, void const*, void*) {};
+
+  std::aligned_storage_t<N> store_;
+
+  template <typename F, typename R, typename ...A>
+  static void invoker(void* const store, void const* const v, void* const r)
+  {
+    *static_cast<R*>(r) = std::apply(*static_cast<F*>(store),
+      *static_cast<std::tuple<A...> const*>(v));
+  }
+
+  template <typename F, typename R, typename ...A>
+  void assign(gnr::detail::signature<R(A...)>) noexcept
+  {
+    f_ = invoker<F, R, A...>;
+  }
+
+public:
+  template <typename F>
+  tuple_callback(F const& f) noexcept
+  {
+    static_assert(sizeof(F) <= N, "functor too large");
+    static_assert(std::is_trivially_copyable<F>{},
+      "functor not trivially copyable");
+
+    ::new (static_cast<void*>(&store_)) F(f);
+
+    assign<F>(gnr::detail::extract_signature(f));
+  }
+
+  template <typename R, typename ...A>
+  R invoke(A... args) const
+  {
+    R r;
+
+    auto const a(std::tuple<A...>{std::move(args)...});
+
+    f_(const_cast<void*>(static_cast<void const*>(&store_)), &a, &r);
+
+    return r;
+  }
+};
+
+// the former gnr::anyfunc, the target is held in a std::any and reached
+// through std::any_cast on every call
+class any_anyfunc
+{
+  void (*f_)(std::any const&, void const*, void*) {};
+
+  std::any any_;
+
+  template <typename F, typename R, typename ...A>
+  static void invoker(std::any const& any, void const* const v,
+    void* const r)
+  {
+    *static_cast<R*>(r) = std::apply(std::any_cast<F>(any),
+      *static_cast<std::tuple<A...> const*>(v));
+  }
+
+  template <typename F, typename R, typename ...A>
+  void assign(gnr::detail::signature<R(A...)>) noexcept
+  {
+    f_ = invoker<F, R, A...>;
+  }
+
+public:
+  template <typename F, typename =
+    std::enable_if_t<!std::is_same<std::decay_t<F>, any_anyfunc>{}>
+  >
+  any_anyfunc(F const& f) : any_(f)
+  {
+    assign<F>(gnr::detail::extract_signature(f));
+  }
+
+  template <typename R, typename ...A>
+  R invoke(A... args) const
+  {
+    R r;
+
+    auto const a(std::tuple<A...>{std::move(args)...});
+
+    f_(any_, &a, &r);
+
+    return r;
+  }
+};
+
+struct S
+{
+  int k;
+
+  int get(int const x) noexcept
+  {
+    return x + k;
+  }
+};
+
+}
+
+int main()
+{
+  auto const call([](auto& w, int const x) { return w(x); });
+
+  auto const call_cb([](auto& w, int const x)
+    {
+      return w.template invoke<int>(x);
+    }
+  );
+
+  int const k(1);
+
+  std::array<int, 16> a{};
+  escape(a);
+
+  auto const captureless([](int const x) noexcept { return x + 1; });
+  auto const small([k](int const x) noexcept { return x + k; });
+  auto const large([a](int const x) noexcept { return x + a[x & 15]; });
+
+  using sig = int(int);
+
+  // captureless
+  run<std::function<sig>>("std::function", "captureless", captureless,
+    call);
+  run<gnr::callback<>>("gnr::callback", "captureless", captureless,
+    call_cb);
+  run<tuple_callback<>>("gnr::callback, tuple", "captureless",
+    captureless, call_cb);
+  run<gnr::forwarder<sig>>("gnr::forwarder", "captureless", captureless,
+    call);
+  run<gnr::fwdref<sig>>("gnr::fwdref", "captureless", captureless, call);
+  run<gnr::anyfunc<>>("gnr::anyfunc", "captureless", captureless,
+    call_cb);
+  run<any_anyfunc>("gnr::anyfunc, std::any", "captureless", captureless,
+    call_cb);
+
+  // small capture
+  run<std::function<sig>>("std::function", "small", small, call);
+  run<gnr::callback<>>("gnr::callback", "small", small, call_cb);
+  run<tuple_callback<>>("gnr::callback, tuple", "small", small, call_cb);
+  run<gnr::forwarder<sig>>("gnr::forwarder", "small", small, call);
+  run<gnr::fwdref<sig>>("gnr::fwdref", "small", small, call);
+  run<gnr::anyfunc<>>("gnr::anyfunc", "small", small, call_cb);
+  run<any_anyfunc>("gnr::anyfunc, std::any", "small", small, call_cb);
+
+  // large capture, spilled to the heap where the store is too small, the
+  // spill policy is measured with a store, that holds it inline, too
+  run<std::function<sig>>("std::function", "large", large, call);
+  run<gnr::callback<gnr::callback<>::size, gnr::callback_policy::spill>>(
+    "gnr::callback, spilled", "large", large, call_cb);
+  run<gnr::callback<sizeof(large), gnr::callback_policy::spill>>(
+    "gnr::callback, inline", "large", large, call_cb);
+  run<gnr::forwarder<sig, sizeof(large)>>("gnr::forwarder", "large", large,
+    call);
+  run<gnr::fwdref<sig>>("gnr::fwdref", "large", large, call);
+  run<gnr::anyfunc<>>("gnr::anyfunc", "large", large, call_cb);
+  run<any_anyfunc>("gnr::anyfunc, std::any", "large", large, call_cb);
+
+  // a capture, that is not trivially copyable
+  auto const managed([p(std::make_shared<int>(k))](int const x) noexcept
+    {
+      return x + *p;
+    }
+  );
+
+  run<std::function<sig>>("std::function", "managed", managed, call);
+  run<gnr::callback<gnr::callback<>::size, gnr::callback_policy::managed>>(
+    "gnr::callback", "managed", managed, call_cb);
+  run<gnr::forwarder<sig, gnr::forwarder<sig>::size,
+    gnr::forwarder_policy::managed>>("gnr::forwarder", "managed", managed,
+    call);
+  run<gnr::fwdref<sig>>("gnr::fwdref", "managed", managed, call);
+  run<gnr::anyfunc<>>("gnr::anyfunc", "managed", managed, call_cb);
+
+  // member function
+  S s{k};
+  escape(s);
+
+  auto const member([&s](int const x) noexcept { return s.get(x); });
+  auto const call_member([&](auto& w, int const x)
+    {
+      return w.template invoke<int>(std::ref(s), x);
+    }
+  );
+  auto const delegate(gnr::memfun<MEMFUN(S::get)>(s));
+
+  run<std::function<sig>>("std::function", "member", member, call);
+  run<gnr::callback<>>("gnr::callback", "member", &S::get,
+    call_member);
+  run<gnr::callback<>>("gnr::callback::bind", "member",
+    gnr::callback<>::bind<&S::get>(),
+    call_member);
+  run<gnr::forwarder<sig>>("gnr::forwarder", "member", member, call);
+  run<gnr::fwdref<sig>>("gnr::fwdref", "member", member, call);
+  run<gnr::anyfunc<>>("gnr::anyfunc", "member", &S::get,
+    call_member);
+  // the delegate is not assignable, it is moved around in a forwarder
+  run<gnr::forwarder<sig>>("gnr::memfun", "member", delegate, call);
+
+  // open versus closed set some
+  run_some<gnr::some<32>>("gnr::some<32>",
+    [](auto const& e)
+    {
+      if (gnr::contains<int>(e))
+      {
+        return double(std::get<int>(e));
+      }
+      else if (gnr::contains<double>(e))
+      {
+        return std::get<double>(e);
+      }
+      else if (gnr::contains<std::string>(e))
+      {
+        return double(std::get<std::string>(e).size());
+      }
+      else
+      {
+        return 0.;
+      }
+    }
+  );
+
+  run_some<gnr::some<32>>("gnr::some<32>, gnr::visit",
+    [](auto const& e)
+    {
+      double r{};
+
+      gnr::visit(e, gnr::overloaded{
+          [&](int const v) { r = v; },
+          [&](double const v) { r = v; },
+          [&](std::string const& v) { r = v.size(); }
+        }
+      );
+
+      return r;
+    }
+  );
+
+  run_some<gnr::some<32, int, double, std::string>>(
+    "gnr::some<32, int, double, std::string>",
+    [](auto const& e)
+    {
+      double r{};
+
+      gnr::visit(e, [&](auto const& v)
+        {
+          if constexpr (std::is_same_v<std::decay_t<decltype(v)>,
+            std::string>)
+          {
+            r = v.size();
+          }
+          else
+          {
+            r = v;
+          }
+        }
+      );
+
+      return r;
+    }
+  );
+
+  run_some_vector();
+
+  // signal lists
+  for (auto const n: {1, 16, 1024})
+  {
+    run_list(n);
+  }
+
+  std::cout << "{\n  \"compiler\": \"" <<
+#if defined(__VERSION__)
+    __VERSION__
+#else
+    "unknown"
+#endif
+    << "\",\n  \"results\": [\n";
+
+  for (auto i(results.cbegin()); results.cend() != i; ++i)
+  {
+    std::cout << "    {\"wrapper\": \"" << i->wrapper <<
+      "\", \"case\": \"" << i->kind <<
+      "\", \"op\": \"" << i->op <<
+      "\", \"value\": " << i->value << '}' <<
+      (results.cend() - 1 == i ? "\n" : ",\n");
+  }
+
+  std::cout << "  ]\n}" << std::endl;
+
+  return 0;
+}
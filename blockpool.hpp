@@ -0,0 +1,149 @@
+#ifndef GNR_BLOCKPOOL_HPP
+# define GNR_BLOCKPOOL_HPP
+# pragma once
+
+// std::size_t, std::max_align_t
+#include <cstddef>
+
+#include <new>
+
+namespace gnr
+{
+
+// per-thread freelist of fixed-size blocks, at most C are cached
+template <std::size_t S, std::size_t C = 64>
+class block_pool
+{
+  struct block
+  {
+    block* next;
+  };
+
+  static constexpr auto const alignment = alignof(std::max_align_t);
+
+  struct freelist
+  {
+    block* head;
+    std::size_t count;
+  };
+
+  // trivially destructible, so that it is usable during thread exit
+  static inline thread_local freelist list_{};
+
+  struct drain
+  {
+    ~drain()
+    {
+      for (auto b(list_.head); b;)
+      {
+        auto const next(b->next);
+
+        ::operator delete(b);
+
+        b = next;
+      }
+
+      // stop caching blocks in this thread
+      list_ = {nullptr, C};
+    }
+  };
+
+  static inline thread_local drain drain_;
+
+public:
+  enum : std::size_t
+  {
+    size = S < sizeof(block) ?
+      sizeof(block) :
+      (S + (alignment - 1)) & -alignment
+  };
+
+  static void* allocate()
+  {
+    if (auto const b(list_.head); b)
+    {
+      list_.head = b->next;
+      --list_.count;
+
+      return b;
+    }
+    else
+    {
+      return ::operator new(size);
+    }
+  }
+
+  static void deallocate(void* const p) noexcept
+  {
+    if (list_.count < C)
+    {
+      // register the drain for this thread
+      (void)&drain_;
+
+      list_.head = ::new (p) block{list_.head};
+      ++list_.count;
+    }
+    else
+    {
+      ::operator delete(p);
+    }
+  }
+};
+
+// single objects come from the block_pool of their size
+template <typename T>
+class block_pool_allocator
+{
+public:
+  using value_type = T;
+
+  block_pool_allocator() = default;
+
+  template <typename U>
+  block_pool_allocator(block_pool_allocator<U> const&) noexcept { }
+
+  T* allocate(std::size_t const n)
+  {
+    if constexpr (alignof(T) <= alignof(std::max_align_t))
+    {
+      return static_cast<T*>(1 == n ?
+        block_pool<sizeof(T)>::allocate() :
+        ::operator new(n * sizeof(T)));
+    }
+    else
+    {
+      return static_cast<T*>(
+        ::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+    }
+  }
+
+  void deallocate(T* const p, std::size_t const n) noexcept
+  {
+    if constexpr (alignof(T) <= alignof(std::max_align_t))
+    {
+      1 == n ?
+        block_pool<sizeof(T)>::deallocate(p) :
+        ::operator delete(p);
+    }
+    else
+    {
+      ::operator delete(p, std::align_val_t(alignof(T)));
+    }
+  }
+
+  template <typename U>
+  bool operator==(block_pool_allocator<U> const&) const noexcept
+  {
+    return true;
+  }
+
+  template <typename U>
+  bool operator!=(block_pool_allocator<U> const&) const noexcept
+  {
+    return false;
+  }
+};
+
+}
+
+#endif // GNR_BLOCKPOOL_HPP
@@ -36,5 +36,16 @@ int main()
 
   f.invoke<void>(std::ref(s));
 
+  char const m[64]{"spilled"};
+
+  gnr::callback<gnr::callback<>::size, gnr::callback_policy::spill> g(
+    [m]()
+    {
+      std::cout << m << std::endl;
+    }
+  );
+
+  g();
+
   return 0;
 }
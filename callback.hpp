@@ -15,317 +15,86 @@
 
 #include <utility>
 
-namespace gnr
-{
-
-namespace detail
-{
-
-namespace callback
-{
-
-constexpr auto default_size = 4 * sizeof(void*);
-
-template <typename>
-struct signature
-{
-};
-
-//
-template <typename>
-struct class_ref;
-
-//
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...)>
-{
-  using type = C&;
-};
-
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...) const>
-{
-  using type = C const&;
-};
-
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...) const volatile>
-{
-  using type = C const volatile&;
-};
+#include "funcstore.hpp"
 
-//
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...) &>
-{
-  using type = C&;
-};
+#include "signature.hpp"
 
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...) const &>
-{
-  using type = C const&;
-};
-
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...) const volatile &>
-{
-  using type = C const volatile&;
-};
-
-//
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...) &&>
-{
-  using type = C&&;
-};
-
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...) const &&>
-{
-  using type = C const&&;
-};
-
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...) const volatile &&>
-{
-  using type = C const volatile&&;
-};
-
-//
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...) noexcept>
-{
-  using type = C&;
-};
-
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...) const noexcept>
-{
-  using type = C const&;
-};
-
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...) const volatile noexcept>
-{
-  using type = C const volatile&;
-};
-
-//
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...) & noexcept>
-{
-  using type = C&;
-};
-
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...) const & noexcept>
-{
-  using type = C const&;
-};
-
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...) const volatile & noexcept>
-{
-  using type = C const volatile&;
-};
-
-//
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...) && noexcept>
-{
-  using type = C&&;
-};
-
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...) const && noexcept>
-{
-  using type = C const &&;
-};
-
-template <typename R, typename C, typename ...A>
-struct class_ref<R (C::*)(A...) const volatile && noexcept>
-{
-  using type = C const volatile &&;
-};
-
-template <typename F>
-using class_ref_t = typename class_ref<F>::type;
-
-//
-template <typename>
-struct remove_cv_seq;
-
-//
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...)>
-{
-  using type = R(A...);
-};
-
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) const>
-{
-  using type = R(A...);
-};
-
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) volatile>
-{
-  using type = R(A...);
-};
-
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) const volatile>
-{
-  using type = R(A...);
-};
-
-//
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) const noexcept>
-{
-  using type = R(A...);
-};
-
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) volatile noexcept>
-{
-  using type = R(A...);
-};
-
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) const volatile noexcept>
-{
-  using type = R(A...);
-};
-
-//
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) &>
-{
-  using type = R(A...);
-};
-
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) const &>
-{
-  using type = R(A...);
-};
-
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) volatile &>
-{
-  using type = R(A...);
-};
-
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) const volatile &>
-{
-  using type = R(A...);
-};
-
-//
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) & noexcept>
-{
-  using type = R(A...);
-};
-
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) const & noexcept >
+namespace gnr
 {
-  using type = R(A...);
-};
 
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) volatile & noexcept>
+enum class callback_policy
 {
-  using type = R(A...);
+  trivial,
+  managed,
+  spill
 };
 
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) const volatile & noexcept>
-{
-  using type = R(A...);
-};
+template <std::size_t, callback_policy>
+class callback_list;
 
-//
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) &&>
+namespace detail
 {
-  using type = R(A...);
-};
 
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) const &&>
+namespace callback
 {
-  using type = R(A...);
-};
 
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) volatile &&>
-{
-  using type = R(A...);
-};
+constexpr auto default_size = 4 * sizeof(void*);
 
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) const volatile &&>
-{
-  using type = R(A...);
-};
+template <auto F,
+  bool = std::is_member_function_pointer<decltype(F)>{},
+  typename = decltype(extract_signature(F))
+>
+struct static_target;
 
-//
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) && noexcept>
+template <auto F, typename R, typename ...A>
+struct static_target<F, false, signature<R(A...)>>
 {
-  using type = R(A...);
+  constexpr R operator()(A... args) const noexcept(
+    noexcept(F(std::forward<A>(args)...)))
+  {
+    return F(std::forward<A>(args)...);
+  }
 };
 
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) const && noexcept>
+template <auto F, typename R, typename ...A>
+struct static_target<F, true, signature<R(A...)>>
 {
-  using type = R(A...);
-};
+  using class_ref_type = class_ref_t<decltype(F)>;
 
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) volatile && noexcept>
-{
-  using type = R(A...);
+  constexpr R operator()(class_ref_type c, A... args) const noexcept(
+    noexcept((std::forward<class_ref_type>(c).*F)(std::forward<A>(args)...)))
+  {
+    return (std::forward<class_ref_type>(c).*F)(std::forward<A>(args)...);
+  }
 };
 
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) const volatile && noexcept>
-{
-  using type = R(A...);
-};
+template <std::size_t N, callback_policy P>
+using callback_impl = funcstore::func_store<void (*)(), N,
+  callback_policy::trivial == P ? funcstore::policy::trivial :
+  callback_policy::managed == P ? funcstore::policy::managed :
+  funcstore::policy::spill
+>;
 
-template <typename F>
-constexpr auto extract_signature(F* const) noexcept
-{
-  return signature<typename remove_cv_seq<F>::type>();
 }
 
-template <typename C, typename F>
-constexpr auto extract_signature(F C::* const) noexcept
-{
-  return signature<typename remove_cv_seq<F>::type>();
 }
 
-template <typename F>
-constexpr auto extract_signature(F const&) noexcept ->
-  decltype(&F::operator(), extract_signature(&F::operator()))
+// the target is a template argument, there is nothing to store
+template <auto F>
+class static_callback : public detail::callback::static_target<F>
 {
-  return extract_signature(&F::operator());
-}
+};
 
-}
+template <std::size_t N = detail::callback::default_size,
+  callback_policy P = callback_policy::trivial
+>
+class callback : public detail::callback::callback_impl<N, P>
+{
+  template <std::size_t, callback_policy>
+  friend class callback_list;
 
-}
+  using inherited_t = detail::callback::callback_impl<N, P>;
 
-template <std::size_t N = detail::callback::default_size>
-class callback
-{
   using typeid_t = void(*)();
 
   template <typename T>
@@ -334,71 +103,28 @@ class callback
     return typeid_t(type_id<T>);
   }
 
-  void (*f_)(void*, void const*, void*) {};
-
-  std::aligned_storage_t<N> store_;
-
 #ifndef NDEBUG
   typeid_t type_id_;
 #endif // NDEBUG
 
-  template <typename F, typename R, typename ...A>
-  static std::enable_if_t<
-    !std::is_member_function_pointer<F>{} &&
-    !std::is_void<R>{}
-  >
-  invoker(void* const store, void const* const v, void* const r)
-  {
-    *static_cast<R*>(r) = std::apply(*static_cast<F*>(store),
-      *static_cast<std::tuple<A...> const*>(v)
-    );
-  }
-
-  template <typename F, typename R, typename ...A>
-  static std::enable_if_t<
-    !std::is_member_function_pointer<F>{} &&
-    std::is_void<R>{}
-  >
-  invoker(void* const store, void const* const v, void*)
+  void* store() const noexcept
   {
-    std::apply(*static_cast<F*>(store),
-      *static_cast<std::tuple<A...> const*>(v)
-    );
+    return const_cast<void*>(static_cast<void const*>(
+      std::addressof(inherited_t::store_)));
   }
 
   template <typename F, typename R, typename ...A>
-  static std::enable_if_t<
-    std::is_member_function_pointer<F>{} &&
-    !std::is_void<R>{}
-  >
-  invoker(void* const store, void const* const v, void* const r)
+  static R invoker(void* const store, A&& ...args)
   {
-    *static_cast<R*>(r) = std::apply(*static_cast<F*>(store),
-      *static_cast<
-        std::tuple<detail::callback::class_ref_t<F>, A...> const*
-      >(v)
-    );
-  }
-
-  template <typename F, typename R, typename ...A>
-  static std::enable_if_t<
-    std::is_member_function_pointer<F>{} &&
-    std::is_void<R>{}
-  >
-  invoker(void* const store, void const* const v, void*)
-  {
-    std::apply(*static_cast<F*>(store),
-      *static_cast<
-        std::tuple<detail::callback::class_ref_t<F>, A...> const*
-      >(v)
-    );
+    return std::invoke(inherited_t::template functor<F>(store),
+      std::forward<A>(args)...);
   }
 
   template <typename F, typename R, typename ...A>
   std::enable_if_t<!std::is_member_function_pointer<F>{}>
-  assign(detail::callback::signature<R(A...)>) noexcept
+  assign(detail::signature<R(A...)>) noexcept
   {
-    f_ = invoker<std::decay_t<F>, R, A...>;
+    inherited_t::f_ = reinterpret_cast<void (*)()>(invoker<F, R, A...>);
 
 #ifndef NDEBUG
     type_id_ = type_id<std::tuple<R, A...>>();
@@ -407,13 +133,14 @@ class callback
 
   template <typename F, typename R, typename ...A>
   std::enable_if_t<std::is_member_function_pointer<F>{}>
-  assign(detail::callback::signature<R(A...)>) noexcept
+  assign(detail::signature<R(A...)>) noexcept
   {
-    f_ = invoker<F, R, A...>;
+    inherited_t::f_ = reinterpret_cast<void (*)()>(
+      invoker<F, R, detail::class_ref_t<F>, A...>);
 
 #ifndef NDEBUG
     type_id_ = type_id<
-      std::tuple<R, detail::callback::class_ref_t<F>, A...>
+      std::tuple<R, detail::class_ref_t<F>, A...>
     >();
 #endif // NDEBUG
   }
@@ -446,14 +173,15 @@ public:
   template <typename F, typename =
     std::enable_if_t<!std::is_same<std::decay_t<F>, callback>{}>
   >
-  callback(F&& f) noexcept
+  callback(F&& f) noexcept(noexcept(
+    std::declval<callback&>().assign(std::forward<F>(f))))
   {
     assign(std::forward<F>(f));
   }
 
   bool operator==(std::nullptr_t) const noexcept
   {
-    return f_;
+    return inherited_t::f_;
   }
 
   bool operator!=(std::nullptr_t) const noexcept
@@ -468,36 +196,20 @@ public:
   template <typename F, typename =
     std::enable_if_t<!std::is_same<std::decay_t<F>, callback>{}>
   >
-  callback& operator=(F&& f) noexcept
+  callback& operator=(F&& f) noexcept(noexcept(
+    std::declval<callback&>().assign(std::forward<F>(f))))
   {
     assign(std::forward<F>(f));
 
     return *this;
   }
 
-  explicit operator bool() const noexcept { return f_; }
-  template <typename R, typename ...A>
-  std::enable_if_t<!std::is_void<R>{}, R>
-  operator()(A&&... args) const noexcept(
-    noexcept(std::declval<callback>().template invoke<R>(
-        std::forward<A>(args)...
-      )
-    )
-  )
-  {
-    return invoke<R>(std::forward<A>(args)...);
-  }
+  explicit operator bool() const noexcept { return inherited_t::f_; }
 
   template <typename R = void, typename ...A>
-  std::enable_if_t<std::is_void<R>{}, R>
-  operator()(A&&... args) const noexcept(
-    noexcept(std::declval<callback>().template invoke<R>(
-        std::forward<A>(args)...
-      )
-    )
-  )
+  R operator()(A&&... args) const
   {
-    invoke<R>(std::forward<A>(args)...);
+    return invoke<R>(std::forward<A>(args)...);
   }
 
   void assign(std::nullptr_t) noexcept
@@ -506,69 +218,58 @@ public:
   }
 
   template <typename F>
-  void assign(F&& f) noexcept
+  void assign(F&& f) noexcept(noexcept(
+    std::declval<callback&>().template emplace<std::decay_t<F>>(
+      std::forward<F>(f))))
   {
     using functor_type = std::decay_t<F>;
 
-    static_assert(sizeof(functor_type) <= sizeof(store_),
-      "functor too large");
-    static_assert(std::is_trivially_copyable<functor_type>{},
-      "functor not trivially copyable");
+    inherited_t::template emplace<functor_type>(std::forward<F>(f));
 
-    ::new (static_cast<void*>(&store_)) functor_type(std::forward<F>(f));
-
-    assign<F>(detail::callback::extract_signature(std::forward<F>(f)));
+    assign<functor_type>(detail::extract_signature(f));
   }
 
-  template <typename R, typename ...A>
-  std::enable_if_t<!std::is_void<R>{}, R>
-  invoke(A... args) const
-    noexcept(
-        noexcept(f_(const_cast<void*>(static_cast<void const*>(&store_)),
-          {},
-          {}
-        )
-      )
-    )
+  template <typename R = void, typename ...A>
+  R invoke(A... args) const
   {
-    assert(f_);
+    assert(inherited_t::f_);
 #ifndef NDEBUG
     using test_t = std::tuple<R, arg_type_t<A>...>;
     assert(type_id<test_t>() == type_id_);
 #endif // NDEBUG
 
-    R r;
-
-    auto const a(std::tuple<arg_type_t<A>...>{std::forward<A>(args)...});
-
-    f_(const_cast<void*>(static_cast<void const*>(&store_)), &a, &r);
-
-    return r;
+    return reinterpret_cast<R (*)(void*, arg_type_t<A>&&...)>(
+      inherited_t::f_)(store(), static_cast<arg_type_t<A>&&>(args)...);
   }
 
-  template <typename R = void, typename ...A>
-  std::enable_if_t<std::is_void<R>{}, R>
-  invoke(A... args) const
-    noexcept(
-        noexcept(f_(const_cast<void*>(static_cast<void const*>(&store_)),
-          {},
-          {}
-        )
-      )
-    )
+  // every callback receives its own copy of the by-value arguments
+  template <typename R = void, typename I, typename ...A>
+  static void invoke_all(I i, I const end, A... args)
   {
-    assert(f_);
+    using stub_t = R (*)(void*, arg_type_t<A>&&...);
+
+    for (; end != i; ++i)
+    {
+      callback const& c(*i);
+
+      assert(c.f_);
 #ifndef NDEBUG
-    using test_t = std::tuple<R, arg_type_t<A>...>;
-    assert(type_id<test_t>() == type_id_);
+      using test_t = std::tuple<R, arg_type_t<A>...>;
+      assert(type_id<test_t>() == c.type_id_);
 #endif // NDEBUG
 
-    auto const a(std::tuple<arg_type_t<A>...>{std::forward<A>(args)...});
+      reinterpret_cast<stub_t>(c.f_)(c.store(),
+        static_cast<arg_type_t<A>>(args)...);
+    }
+  }
 
-    f_(const_cast<void*>(static_cast<void const*>(&store_)), &a, {});
+  template <auto F>
+  static callback bind() noexcept
+  {
+    return static_callback<F>();
   }
 
-  void reset() noexcept { f_ = {}; }
+  void reset() noexcept { inherited_t::clear(); }
 
   void swap(callback& other) noexcept
   {
@@ -583,13 +284,13 @@ public:
   template <typename T>
   auto target() noexcept
   {
-    return reinterpret_cast<T*>(&store_);
+    return &inherited_t::template functor<T>(store());
   }
 
   template <typename T> 
   auto target() const noexcept
   {
-    return reinterpret_cast<T const*>(&store_);
+    return const_cast<T const*>(&inherited_t::template functor<T>(store()));
   }
 };
 
@@ -0,0 +1,73 @@
+// g++ -std=c++17 callbacklist.cpp -o callbacklist
+#include <cassert>
+
+#include <iostream>
+
+#include <string>
+
+#include <vector>
+
+#include "callbacklist.hpp"
+
+int main()
+{
+  std::vector<std::string> log;
+
+  auto const p(&log);
+
+  auto const dump([&]()
+    {
+      for (auto& s: log)
+      {
+        std::cout << s << ' ';
+      }
+
+      std::cout << std::endl;
+
+      log.clear();
+    }
+  );
+
+  // every kind has its own invoker, k tells the callbacks of a kind apart
+  auto const a([p](char const k)
+    {
+      return [p, k](int const i) { p->push_back(k + std::to_string(i)); };
+    }
+  );
+  auto const b([p](char const k)
+    {
+      return [p, k](int const i) { p->push_back(k + std::to_string(-i)); };
+    }
+  );
+
+  gnr::callback_list<> l;
+
+  l.push_back(b('x'));
+  l.push_back(a('y'));
+  l.push_back(b('z'));
+  l.push_back(a('u'));
+  l.push_back(b('v'));
+  l.push_back([p](int) { p->push_back("w"); });
+
+  assert(6 == l.size());
+
+  l.invoke_all(1);
+
+  // runs in the order of their first callback, b, a, then the last one,
+  // insertion order within a run
+  assert((std::vector<std::string>{"x-1", "z-1", "v-1", "y1", "u1", "w"} ==
+    log));
+
+  dump();
+
+  // a plain vector is invoked in insertion order
+  std::vector<gnr::callback<>> v{b('x'), a('y'), b('z')};
+
+  gnr::invoke_all(v, 2);
+
+  assert((std::vector<std::string>{"x-2", "y2", "z-2"} == log));
+
+  dump();
+
+  return 0;
+}
@@ -0,0 +1,99 @@
+#ifndef GNR_CALLBACKLIST_HPP
+# define GNR_CALLBACKLIST_HPP
+# pragma once
+
+#include <algorithm>
+
+#include <iterator>
+
+#include <vector>
+
+#include "callback.hpp"
+
+namespace gnr
+{
+
+// callbacks sharing an invoker are kept adjacent, so that runs of the same
+// stub are dispatched back to back; invocation order is by insertion within
+// a run, runs are ordered by the insertion of their first callback
+template <std::size_t N = detail::callback::default_size,
+  callback_policy P = callback_policy::trivial
+>
+class callback_list
+{
+public:
+  using value_type = callback<N, P>;
+
+  using size_type = typename std::vector<value_type>::size_type;
+
+  using const_iterator = typename std::vector<value_type>::const_iterator;
+
+private:
+  std::vector<value_type> v_;
+
+public:
+  callback_list() = default;
+
+  callback_list(callback_list const&) = default;
+
+  callback_list(callback_list&&) = default;
+
+  callback_list& operator=(callback_list const&) = default;
+
+  callback_list& operator=(callback_list&&) = default;
+
+  template <typename R = void, typename ...A>
+  void operator()(A&& ...args) const
+  {
+    invoke_all<R>(std::forward<A>(args)...);
+  }
+
+  template <typename F>
+  void push_back(F&& f)
+  {
+    value_type c(std::forward<F>(f));
+
+    auto const stub(c.f_);
+
+    // insert after the last callback with the same invoker
+    auto const i(std::find_if(v_.rbegin(), v_.rend(),
+      [stub](auto& e) noexcept { return stub == e.f_; }).base());
+
+    v_.insert(v_.begin() == i ? v_.end() : i, std::move(c));
+  }
+
+  template <typename R = void, typename ...A>
+  void invoke_all(A&& ...args) const
+  {
+    value_type::template invoke_all<R>(v_.cbegin(), v_.cend(),
+      std::forward<A>(args)...);
+  }
+
+  void clear() noexcept { v_.clear(); }
+
+  bool empty() const noexcept { return v_.empty(); }
+
+  size_type size() const noexcept { return v_.size(); }
+
+  void reserve(size_type const n) { v_.reserve(n); }
+
+  auto begin() const noexcept { return v_.cbegin(); }
+
+  auto end() const noexcept { return v_.cend(); }
+};
+
+template <typename R = void, typename C, typename ...A>
+inline void invoke_all(C const& c, A&& ...args)
+{
+  using std::begin;
+  using std::end;
+
+  using value_type = std::decay_t<decltype(*begin(c))>;
+
+  value_type::template invoke_all<R>(begin(c), end(c),
+    std::forward<A>(args)...);
+}
+
+}
+
+#endif // GNR_CALLBACKLIST_HPP
@@ -6,114 +6,16 @@
 
 #include <utility>
 
+#include "signature.hpp"
+
 namespace gnr
 {
 
 namespace cify_
 {
 
-template <typename>
-struct signature
-{
-};
-
-//
-template <typename>
-struct remove_cv_seq;
-
-//
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...)>
-{
-  using type = R(A...);
-};
-
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) const>
-{
-  using type = R(A...);
-};
-
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) volatile>
-{
-  using type = R(A...);
-};
-
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) const volatile>
-{
-  using type = R(A...);
-};
-
-//
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) &>
-{
-  using type = R(A...);
-};
-
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) const &>
-{
-  using type = R(A...);
-};
-
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) volatile &>
-{
-  using type = R(A...);
-};
-
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) const volatile &>
-{
-  using type = R(A...);
-};
-
-//
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) &&>
-{
-  using type = R(A...);
-};
-
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) const &&>
-{
-  using type = R(A...);
-};
-
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) volatile &&>
-{
-  using type = R(A...);
-};
-
-template <typename R, typename ...A>
-struct remove_cv_seq<R(A...) const volatile &&>
-{
-  using type = R(A...);
-};
-
-template <typename F>
-constexpr inline auto extract_signature(F*) noexcept
-{
-  return signature<typename remove_cv_seq<F>::type>();
-}
-
-template <typename C, typename F>
-constexpr inline auto extract_signature(F C::*) noexcept
-{
-  return signature<typename remove_cv_seq<F>::type>();
-}
-
-template <typename F>
-constexpr inline auto extract_signature(F const&) noexcept ->
-  decltype(&F::operator(), extract_signature(&F::operator()))
-{
-  return extract_signature(&F::operator());
-}
+using gnr::detail::extract_signature;
+using gnr::detail::signature;
 
 //////////////////////////////////////////////////////////////////////////////
 template <int I, typename F, typename R, typename ...A>
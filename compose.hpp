@@ -6,38 +6,13 @@
 
 #include <utility>
 
-namespace
-{
-
-template <typename R, typename ...A>
-struct signature
-{
-};
-
-template <typename R, typename ...A>
-constexpr auto extract_signature(R (*const)(A...)) noexcept
-{
-  return signature<R, A...>();
-}
+#include "signature.hpp"
 
-template <typename C, typename R, typename ...A>
-constexpr auto extract_signature(R (C::* const)(A...)) noexcept
+namespace
 {
-  return signature<R, A...>();
-}
 
-template <typename C, typename R, typename ...A>
-constexpr auto extract_signature(R (C::* const)(A...) const) noexcept
-{
-  return signature<R, A...>();
-}
-
-template <typename F>
-constexpr auto extract_signature(F const&) noexcept ->
-  decltype(&F::operator(), extract_signature(&F::operator()))
-{
-  return extract_signature(&F::operator());
-}
+using gnr::detail::extract_signature;
+using gnr::detail::signature;
 
 template <typename F1, typename F2, bool, typename ...A1>
 class composer;
@@ -90,8 +65,8 @@ template <
   typename F2, typename R2, typename ...A2
 >
 inline auto compose(
-  F1&& f1, signature<R1, A1...> const,
-  F2&& f2, signature<R2, A2...> const) noexcept(
+  F1&& f1, signature<R1(A1...)> const,
+  F2&& f2, signature<R2(A2...)> const) noexcept(
   noexcept(
     composer<F1, F2, sizeof...(A2), A1...>(std::forward<F1>(f1),
       std::forward<F2>(f2)
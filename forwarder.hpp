@@ -11,24 +11,54 @@
 
 #include <utility>
 
+#include "funcstore.hpp"
+
 namespace gnr
 {
 
+enum class forwarder_policy
+{
+  trivial,
+  managed
+};
+
 namespace detail::forwarder
 {
 
 enum : std::size_t { default_size = 4 * sizeof(void*) };
 
-template <typename, std::size_t, bool>
+// the layout of the trivial policy
+template <typename S, std::size_t N>
+struct trivial_layout
+{
+  S stub;
+  std::aligned_storage_t<N> store;
+};
+
+template <typename S, std::size_t N, forwarder_policy P>
+using forwarder_store = funcstore::func_store<S, N,
+  forwarder_policy::managed == P ? funcstore::policy::managed :
+  funcstore::policy::trivial
+>;
+
+template <typename, std::size_t, bool, forwarder_policy>
 class forwarder_impl2;
 
-template <typename R, typename ...A, std::size_t N, bool E>
-class forwarder_impl2<R (A...), N, E>
+template <typename R, typename ...A, std::size_t N, bool E,
+  forwarder_policy P
+>
+class forwarder_impl2<R (A...), N, E, P> :
+  public forwarder_store<R (*)(void const*, A&&...) noexcept(E), N, P>
 {
 protected:
-  R (*stub_)(void const*, A&&...) noexcept(E) {};
+  using f_type = R (*)(void const*, A&&...) noexcept(E);
+
+  using store_t = forwarder_store<f_type, N, P>;
 
-  std::aligned_storage_t<N> store_;
+  static_assert((forwarder_policy::managed == P) ||
+    ((sizeof(store_t) == sizeof(trivial_layout<f_type, N>)) &&
+    std::is_trivially_copyable<store_t>{}),
+    "unexpected layout");
 
   template <typename F>
   static constexpr auto is_invocable() noexcept
@@ -42,8 +72,9 @@ public:
 public:
   R operator()(A... args) const noexcept(E)
   {
-    //assert(stub_);
-    return stub_(std::addressof(store_), std::forward<A>(args)...);
+    //assert(f_);
+    return store_t::f_(std::addressof(store_t::store_),
+      std::forward<A>(args)...);
   }
 
   template <typename F,
@@ -52,14 +83,10 @@ public:
   void assign(F&& f) noexcept(noexcept(std::decay_t<F>(std::forward<F>(f))))
   {
     using functor_type = std::decay_t<F>;
-    static_assert(sizeof(functor_type) <= sizeof(store_),
-      "functor too large");
-    static_assert(std::is_trivially_copyable<functor_type>{},
-      "functor not trivially copyable");
 
-    ::new (std::addressof(store_)) functor_type(std::forward<F>(f));
+    store_t::template emplace<functor_type>(std::forward<F>(f));
 
-    stub_ = [](void const* const ptr, A&&... args) noexcept(E) -> R
+    store_t::f_ = [](void const* const ptr, A&&... args) noexcept(E) -> R
       {
         return std::invoke(
           *static_cast<functor_type*>(const_cast<void*>(ptr)),
@@ -68,27 +95,29 @@ public:
   }
 };
 
-template <typename, std::size_t>
+template <typename, std::size_t, forwarder_policy>
 class forwarder_impl;
 
-template <typename R, typename ...A, std::size_t N>
-class forwarder_impl<R (A...), N> :
-  public forwarder_impl2<R (A...), N, false>
+template <typename R, typename ...A, std::size_t N, forwarder_policy P>
+class forwarder_impl<R (A...), N, P> :
+  public forwarder_impl2<R (A...), N, false, P>
 {
 };
 
-template <typename R, typename ...A, std::size_t N>
-class forwarder_impl<R (A...) noexcept, N> :
-  public forwarder_impl2<R (A...), N, true>
+template <typename R, typename ...A, std::size_t N, forwarder_policy P>
+class forwarder_impl<R (A...) noexcept, N, P> :
+  public forwarder_impl2<R (A...), N, true, P>
 {
 };
 
 }
 
-template <typename A, std::size_t N = detail::forwarder::default_size>
-class forwarder : public detail::forwarder::forwarder_impl<A, N>
+template <typename A, std::size_t N = detail::forwarder::default_size,
+  forwarder_policy P = forwarder_policy::trivial
+>
+class forwarder : public detail::forwarder::forwarder_impl<A, N, P>
 {
-  using inherited_t = detail::forwarder::forwarder_impl<A, N>;
+  using inherited_t = detail::forwarder::forwarder_impl<A, N, P>;
 
 public:
   enum : std::size_t { size = N };
@@ -129,7 +158,7 @@ public:
 
   explicit operator bool() const noexcept
   {
-    return inherited_t::stub_;
+    return inherited_t::f_;
   }
 
   bool operator==(std::nullptr_t) noexcept
@@ -149,7 +178,7 @@ public:
 
   void reset() noexcept
   {
-    inherited_t::stub_ = {};
+    inherited_t::clear();
   }
 
   void swap(forwarder& other) noexcept
@@ -0,0 +1,344 @@
+#ifndef GNR_FUNCSTORE_HPP
+# define GNR_FUNCSTORE_HPP
+# pragma once
+
+// std::size_t, std::max_align_t
+#include <cstddef>
+
+#include <new>
+
+#include <type_traits>
+
+#include <typeinfo>
+
+#include <utility>
+
+#include "blockpool.hpp"
+
+namespace gnr::detail::funcstore
+{
+
+enum class policy
+{
+  trivial, // trivially copyable functors only
+  managed, // any nothrow movable functor, that fits
+  spill // anything, what does not fit goes to a pooled block
+};
+
+// the operations on a stored functor, that is not trivially copyable
+struct meta
+{
+  void (*copier)(void*, void const*);
+  void (*mover)(void*, void*);
+  void (*deleter)(void*);
+};
+
+// the functor is stored inline
+template <typename F>
+struct inplace
+{
+  static void copier(void* const dst, void const* const src)
+  {
+    if constexpr (std::is_copy_constructible<F>{})
+    {
+      ::new (dst) F(*static_cast<F const*>(src));
+    }
+    // else do nothing
+  }
+
+  static void mover(void* const dst, void* const src) noexcept
+  {
+    auto const p(static_cast<F*>(src));
+
+    ::new (dst) F(std::move(*p));
+
+    p->~F();
+  }
+
+  static void deleter(void* const store) noexcept
+  {
+    static_cast<F*>(store)->~F();
+  }
+
+  static constexpr struct meta const meta_{
+    std::is_copy_constructible<F>{} ? copier : nullptr,
+    mover,
+    deleter
+  };
+};
+
+// the store holds a pointer to a pooled block
+template <typename F>
+struct spilled
+{
+  using pool = block_pool<sizeof(F)>;
+
+  template <typename ...A>
+  static F* create(A&& ...args)
+  {
+    auto const p(pool::allocate());
+
+#if defined(__cpp_exceptions)
+    try
+    {
+      return ::new (p) F(std::forward<A>(args)...);
+    }
+    catch (...)
+    {
+      pool::deallocate(p);
+
+      throw;
+    }
+#else
+    return ::new (p) F(std::forward<A>(args)...);
+#endif
+  }
+
+  static void copier(void* const dst, void const* const src)
+  {
+    if constexpr (std::is_copy_constructible<F>{})
+    {
+      *static_cast<F**>(dst) = create(**static_cast<F const* const*>(src));
+    }
+    // else do nothing
+  }
+
+  static void mover(void* const dst, void* const src) noexcept
+  {
+    *static_cast<F**>(dst) = *static_cast<F**>(src);
+  }
+
+  static void deleter(void* const store) noexcept
+  {
+    auto const p(*static_cast<F**>(store));
+
+    p->~F();
+
+    pool::deallocate(p);
+  }
+
+  static constexpr struct meta const meta_{
+    std::is_copy_constructible<F>{} ? copier : nullptr,
+    mover,
+    deleter
+  };
+};
+
+// constructs F inside store, returns the meta to keep, if any
+template <typename F, typename S, typename G>
+struct meta const* emplace_inplace(S& store, G&& g) noexcept(
+  std::is_nothrow_constructible<F, G>{})
+{
+  static_assert(sizeof(F) <= sizeof(S), "functor too large");
+  static_assert(alignof(F) <= alignof(S), "functor overaligned");
+  static_assert(std::is_nothrow_move_constructible<F>{},
+    "functor move constructor may throw");
+
+  ::new (static_cast<void*>(std::addressof(store))) F(std::forward<G>(g));
+
+  if constexpr (std::is_trivially_copyable<F>{})
+  {
+    return nullptr;
+  }
+  else
+  {
+    return &inplace<F>::meta_;
+  }
+}
+
+// constructs F in a pooled block, whose address goes into store
+template <typename F, typename S, typename G>
+struct meta const* emplace_spilled(S& store, G&& g)
+{
+  static_assert(sizeof(F*) <= sizeof(S), "store too small");
+  static_assert(alignof(F) <= alignof(std::max_align_t),
+    "functor overaligned");
+
+  *reinterpret_cast<F**>(std::addressof(store)) =
+    spilled<F>::create(std::forward<G>(g));
+
+  return &spilled<F>::meta_;
+}
+
+// the stub S and the functor store of a callable wrapper
+template <typename S, std::size_t N, policy P>
+class func_store
+{
+  static_assert((policy::spill != P) || (N >= sizeof(void*)),
+    "store too small");
+
+protected:
+  S f_{};
+
+  struct meta const* meta_{};
+
+  std::aligned_storage_t<N> store_;
+
+  template <typename F>
+  static constexpr bool is_spilled() noexcept
+  {
+    return (policy::spill == P) &&
+      ((sizeof(F) > N) ||
+      (alignof(F) > alignof(decltype(store_))) ||
+      !std::is_nothrow_move_constructible<F>{});
+  }
+
+  template <typename F>
+  static F& functor(void* const store) noexcept
+  {
+    if constexpr (is_spilled<F>())
+    {
+      return **static_cast<F**>(store);
+    }
+    else
+    {
+      return *static_cast<F*>(store);
+    }
+  }
+
+  void clear() noexcept
+  {
+    if (meta_)
+    {
+      meta_->deleter(&store_);
+
+      meta_ = {};
+    }
+    // else do nothing
+
+    f_ = {};
+  }
+
+  void copy(func_store const& other)
+  {
+    if (auto const m(other.meta_); !m)
+    {
+      store_ = other.store_;
+    }
+    else if (m->copier)
+    {
+      m->copier(&store_, &other.store_);
+
+      meta_ = m;
+    }
+    else
+    {
+#if defined(__cpp_exceptions)
+      throw std::bad_typeid();
+#else
+      return;
+#endif
+    }
+
+    f_ = other.f_;
+  }
+
+  void move(func_store& other) noexcept
+  {
+    f_ = other.f_;
+
+    if ((meta_ = other.meta_))
+    {
+      meta_->mover(&store_, &other.store_);
+
+      other.meta_ = {};
+      other.f_ = {};
+    }
+    else
+    {
+      store_ = other.store_;
+    }
+  }
+
+  template <typename F, typename G>
+  void emplace(G&& g) noexcept(
+    !is_spilled<F>() && std::is_nothrow_constructible<F, G>{})
+  {
+    clear();
+
+    if constexpr (is_spilled<F>())
+    {
+      meta_ = emplace_spilled<F>(store_, std::forward<G>(g));
+    }
+    else
+    {
+      meta_ = emplace_inplace<F>(store_, std::forward<G>(g));
+    }
+  }
+
+public:
+  func_store() = default;
+
+  func_store(func_store const& other) { copy(other); }
+
+  func_store(func_store&& other) noexcept { move(other); }
+
+  ~func_store()
+  {
+    if (meta_)
+    {
+      meta_->deleter(&store_);
+    }
+    // else do nothing
+  }
+
+  func_store& operator=(func_store const& rhs)
+  {
+    if (this != &rhs)
+    {
+      clear();
+      copy(rhs);
+    }
+    // else do nothing
+
+    return *this;
+  }
+
+  func_store& operator=(func_store&& rhs) noexcept
+  {
+    if (this != &rhs)
+    {
+      clear();
+      move(rhs);
+    }
+    // else do nothing
+
+    return *this;
+  }
+};
+
+// trivially copyable, no meta is kept
+template <typename S, std::size_t N>
+class func_store<S, N, policy::trivial>
+{
+protected:
+  S f_{};
+
+  std::aligned_storage_t<N> store_;
+
+  template <typename F>
+  static F& functor(void* const store) noexcept
+  {
+    return *static_cast<F*>(store);
+  }
+
+  void clear() noexcept
+  {
+    f_ = {};
+  }
+
+  template <typename F, typename G>
+  void emplace(G&& g) noexcept(std::is_nothrow_constructible<F, G>{})
+  {
+    static_assert(sizeof(F) <= sizeof(store_),
+      "functor too large");
+    static_assert(std::is_trivially_copyable<F>{},
+      "functor not trivially copyable");
+
+    ::new (static_cast<void*>(&store_)) F(std::forward<G>(g));
+  }
+};
+
+}
+
+#endif // GNR_FUNCSTORE_HPP
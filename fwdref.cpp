@@ -0,0 +1,61 @@
+// g++ -std=c++17 -DGNR_FWDREF_CHECK fwdref.cpp -o fwdref
+#include <cassert>
+
+#include <csignal>
+
+#include <cstdlib>
+
+#include <iostream>
+
+#include <optional>
+
+#include "fwdref.hpp"
+
+int apply(gnr::fwdref<int(int)> const f, int const x)
+{
+  return f(x);
+}
+
+int main()
+{
+  int k(1);
+
+  auto const add([&](int const x) noexcept { return x + k; });
+
+  // a fwdref only refers to the functor, it is never copied
+  assert(3 == apply(add, 2));
+
+  k = 10;
+  assert(12 == apply(add, 2));
+
+  std::cout << "untracked: " << apply(add, 2) << std::endl;
+
+  // a tracked target, destroyed while a fwdref still refers to it; the
+  // optional keeps its storage around, so the check is not itself a stale
+  // access
+  std::optional<gnr::fwdref_tracked<decltype(add)>> t(std::in_place, add);
+
+  gnr::fwdref<int(int)> const f(*t);
+
+  assert(f && (12 == f(2)));
+
+  std::cout << "tracked: " << f(2) << std::endl;
+
+  t.reset();
+
+#if defined(GNR_FWDREF_CHECK)
+  // the check aborts, which is the expected outcome here
+  std::signal(SIGABRT, [](int) { std::_Exit(EXIT_SUCCESS); });
+
+  std::cout << "stale call, expecting a trap" << std::endl;
+
+  f(2);
+
+  // not reached, the call aborts
+  std::cerr << "stale call not trapped" << std::endl;
+
+  return EXIT_FAILURE;
+#else
+  return 0;
+#endif // GNR_FWDREF_CHECK
+}
@@ -5,6 +5,14 @@
 // std::memcpy
 #include <cstring>
 
+#if defined(GNR_FWDREF_CHECK)
+#include <cstdint>
+
+#include <cstdlib>
+
+#include <atomic>
+#endif // GNR_FWDREF_CHECK
+
 #include <functional>
 
 #include <type_traits>
@@ -14,9 +22,31 @@
 namespace gnr
 {
 
+// define GNR_FWDREF_CHECK to trap calls through a fwdref whose referent,
+// wrapped by fwdref_track(), has been destroyed; define GNR_FWDREF_SANITIZE
+// to make every call touch the referent, so that address sanitizer reports
+// stale use even for stateless functors
+template <typename F>
+class fwdref_tracked;
+
 namespace detail::fwdref
 {
 
+template <typename>
+struct is_tracked : std::false_type {};
+
+template <typename F>
+struct is_tracked<fwdref_tracked<F>> : std::true_type {};
+
+#if defined(GNR_FWDREF_CHECK)
+inline std::uint64_t next_generation() noexcept
+{
+  static std::atomic<std::uint64_t> g;
+
+  return ++g;
+}
+#endif // GNR_FWDREF_CHECK
+
 template <typename, bool>
 class fwdref_impl2;
 
@@ -28,6 +58,12 @@ protected:
 
   void const* store_;
 
+#if defined(GNR_FWDREF_CHECK)
+  // generation of a tracked referent, when it was bound
+  std::uint64_t const volatile* genp_{};
+  std::uint64_t gen_{};
+#endif // GNR_FWDREF_CHECK
+
   template <typename F>
   static constexpr auto is_invocable() noexcept
   {
@@ -41,6 +77,18 @@ public:
   R operator()(A... args) const noexcept(E)
   {
     //assert(stub_);
+#if defined(GNR_FWDREF_CHECK)
+    if (genp_ && (*genp_ != gen_))
+    {
+      std::abort();
+    }
+    // else do nothing
+#endif // GNR_FWDREF_CHECK
+
+#if defined(GNR_FWDREF_SANITIZE)
+    (void)*static_cast<char const volatile*>(store_);
+#endif // GNR_FWDREF_SANITIZE
+
     return stub_(store_, std::forward<A>(args)...);
   }
 
@@ -54,6 +102,18 @@ public:
 
     store_ = &f;
 
+#if defined(GNR_FWDREF_CHECK)
+    if constexpr (is_tracked<std::decay_t<F>>{})
+    {
+      genp_ = f.generation_ptr();
+      gen_ = *genp_;
+    }
+    else
+    {
+      genp_ = {};
+    }
+#endif // GNR_FWDREF_CHECK
+
     stub_ = [](void const* const ptr, A&&... args) noexcept(E) -> R
       {
         return std::invoke(
@@ -80,6 +140,77 @@ class fwdref_impl<R (A...) noexcept> :
 
 }
 
+// wraps a functor, so that fwdrefs bound to it can detect its destruction
+template <typename F>
+class fwdref_tracked
+{
+  template <typename, bool>
+  friend class detail::fwdref::fwdref_impl2;
+
+  F f_;
+
+#if defined(GNR_FWDREF_CHECK)
+  std::uint64_t gen_{detail::fwdref::next_generation()};
+
+  auto generation_ptr() const noexcept
+  {
+    return static_cast<std::uint64_t const volatile*>(&gen_);
+  }
+#endif // GNR_FWDREF_CHECK
+
+public:
+  template <typename G,
+    typename = std::enable_if_t<!std::is_same_v<std::decay_t<G>,
+      fwdref_tracked>
+    >
+  >
+  explicit fwdref_tracked(G&& g) noexcept(noexcept(F(std::forward<G>(g)))) :
+    f_(std::forward<G>(g))
+  {
+  }
+
+  fwdref_tracked(fwdref_tracked const& other) : f_(other.f_) {}
+
+  fwdref_tracked(fwdref_tracked&& other) noexcept(
+    std::is_nothrow_move_constructible_v<F>) :
+    f_(std::move(other.f_))
+  {
+  }
+
+#if defined(GNR_FWDREF_CHECK)
+  ~fwdref_tracked()
+  {
+    // volatile, so that the dead store is not elided
+    *static_cast<std::uint64_t volatile*>(&gen_) = {};
+  }
+#endif // GNR_FWDREF_CHECK
+
+  fwdref_tracked& operator=(fwdref_tracked const&) = delete;
+
+  fwdref_tracked& operator=(fwdref_tracked&&) = delete;
+
+  template <typename ...A>
+  decltype(auto) operator()(A&& ...args) noexcept(
+    noexcept(std::invoke(f_, std::forward<A>(args)...)))
+  {
+    return std::invoke(f_, std::forward<A>(args)...);
+  }
+
+  template <typename ...A>
+  decltype(auto) operator()(A&& ...args) const noexcept(
+    noexcept(std::invoke(f_, std::forward<A>(args)...)))
+  {
+    return std::invoke(f_, std::forward<A>(args)...);
+  }
+};
+
+template <typename F>
+inline auto fwdref_track(F&& f) noexcept(
+  noexcept(fwdref_tracked<std::decay_t<F>>(std::forward<F>(f))))
+{
+  return fwdref_tracked<std::decay_t<F>>(std::forward<F>(f));
+}
+
 template <typename A>
 class fwdref : public detail::fwdref::fwdref_impl<A>
 {
@@ -143,8 +274,16 @@ public:
   void reset() noexcept
   {
     inherited_t::stub_ = {};
+
+#if defined(GNR_FWDREF_CHECK)
+    inherited_t::genp_ = {};
+#endif // GNR_FWDREF_CHECK
   }
 
+#if !defined(GNR_FWDREF_CHECK)
+  static_assert(sizeof(inherited_t) == 2 * sizeof(void*));
+#endif // GNR_FWDREF_CHECK
+
   void swap(fwdref& other) noexcept
   {
     std::swap(*this, other);
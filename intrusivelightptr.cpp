@@ -0,0 +1,83 @@
+// g++ -std=c++17 intrusivelightptr.cpp -o intrusivelightptr
+#include <cassert>
+
+#include <iostream>
+
+#include <unordered_set>
+
+#include "intrusivelightptr.hpp"
+
+struct node : gnr::light_ref_counted<node>
+{
+  static inline int live;
+
+  int value;
+
+  explicit node(int const v) noexcept : value(v) { ++live; }
+
+  node(node const& other) noexcept :
+    light_ref_counted(other),
+    value(other.value)
+  {
+    ++live;
+  }
+
+  ~node() { --live; }
+};
+
+struct local_node :
+  gnr::light_ref_counted<local_node, gnr::light_ptr_policy::local>
+{
+  int value;
+
+  explicit local_node(int const v) noexcept : value(v) { }
+};
+
+int main()
+{
+  static_assert(sizeof(gnr::intrusive_light_ptr<node>) == sizeof(node*));
+
+  {
+    auto p(gnr::make_intrusive_light<node>(1));
+    assert(p.unique());
+
+    auto q(p);
+    assert((2 == p.use_count()) && (p == q));
+
+    // the count lives in the object, a raw pointer may be adopted again
+    gnr::intrusive_light_ptr<node> r(q.get());
+    assert(3 == p.use_count());
+
+    std::cout << "count: " << p.use_count() << std::endl;
+
+    // a copy of the value does not copy the count
+    node const n(*p);
+    assert((3 == p.use_count()) && (2 == node::live));
+
+    q.reset();
+    r = nullptr;
+    assert(p.unique() && (1 == p->value));
+
+    std::unordered_set<gnr::intrusive_light_ptr<node>> s{p, p};
+    assert((1 == s.size()) && (2 == p.use_count()));
+  }
+
+  assert(!node::live);
+
+  {
+    auto p(gnr::make_intrusive_light<local_node>(2));
+    auto const q(p);
+
+    assert(2 == q.use_count());
+
+    p.reset();
+
+    assert(q.unique());
+
+    std::cout << "local count: " << q.use_count() << std::endl;
+  }
+
+  std::cout << "live: " << node::live << std::endl;
+
+  return 0;
+}
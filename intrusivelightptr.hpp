@@ -0,0 +1,231 @@
+#ifndef GNR_INTRUSIVELIGHTPTR_HPP
+# define GNR_INTRUSIVELIGHTPTR_HPP
+# pragma once
+
+#include <atomic>
+
+// std::size_t
+#include <cstddef>
+
+#include <functional>
+
+#include <memory>
+
+#include <type_traits>
+
+#include <utility>
+
+#include "lightptr.hpp"
+
+namespace gnr
+{
+
+template <typename T, light_ptr_policy = light_ptr_policy::atomic,
+  typename = std::default_delete<T>
+>
+class light_ref_counted;
+
+template <typename T>
+class intrusive_light_ptr;
+
+// a base for T, that keeps the reference count inside the object
+template <typename T, light_ptr_policy P, typename D>
+class light_ref_counted
+{
+  static_assert(light_ptr_policy::deferred != P,
+    "deferred reclamation is not supported");
+
+  template <typename> friend class intrusive_light_ptr;
+
+  mutable std::conditional_t<light_ptr_policy::local != P,
+    atomic_counter_type,
+    counter_type
+  > counter_{};
+
+  void inc_ref() const noexcept
+  {
+    if constexpr (light_ptr_policy::local != P)
+    {
+      counter_.fetch_add(counter_type(1), std::memory_order_relaxed);
+    }
+    else
+    {
+      ++counter_;
+    }
+  }
+
+  void dec_ref() const noexcept
+  {
+    if constexpr (light_ptr_policy::local != P)
+    {
+      if (counter_type(1) ==
+        counter_.fetch_sub(counter_type(1), std::memory_order_acq_rel))
+      {
+        D()(static_cast<T*>(const_cast<light_ref_counted*>(this)));
+      }
+      // else do nothing
+    }
+    else if (!--counter_)
+    {
+      D()(static_cast<T*>(const_cast<light_ref_counted*>(this)));
+    }
+    // else do nothing
+  }
+
+  counter_type use_count() const noexcept
+  {
+    if constexpr (light_ptr_policy::local != P)
+    {
+      return counter_.load(std::memory_order_relaxed);
+    }
+    else
+    {
+      return counter_;
+    }
+  }
+
+protected:
+  light_ref_counted() = default;
+
+  // the count belongs to the object, not to its value
+  light_ref_counted(light_ref_counted const&) noexcept { }
+
+  ~light_ref_counted() = default;
+
+  light_ref_counted& operator=(light_ref_counted const&) noexcept
+  {
+    return *this;
+  }
+};
+
+// one pointer wide, the count lives in T
+template <typename T>
+class intrusive_light_ptr
+{
+  template <typename U> friend struct std::hash;
+
+  T* ptr_{};
+
+public:
+  using element_type = T;
+
+  intrusive_light_ptr() = default;
+
+  explicit intrusive_light_ptr(T* const p) noexcept : ptr_(p)
+  {
+    if (p)
+    {
+      p->inc_ref();
+    }
+    // else do nothing
+  }
+
+  intrusive_light_ptr(intrusive_light_ptr const& other) noexcept :
+    intrusive_light_ptr(other.ptr_)
+  {
+  }
+
+  intrusive_light_ptr(intrusive_light_ptr&& other) noexcept :
+    ptr_(std::exchange(other.ptr_, nullptr))
+  {
+  }
+
+  ~intrusive_light_ptr() noexcept
+  {
+    if (ptr_)
+    {
+      ptr_->dec_ref();
+    }
+    // else do nothing
+  }
+
+  intrusive_light_ptr& operator=(intrusive_light_ptr const& rhs) noexcept
+  {
+    // the count is raised first, so that self assignment is safe
+    intrusive_light_ptr(rhs).swap(*this);
+
+    return *this;
+  }
+
+  intrusive_light_ptr& operator=(intrusive_light_ptr&& rhs) noexcept
+  {
+    intrusive_light_ptr(std::move(rhs)).swap(*this);
+
+    return *this;
+  }
+
+  intrusive_light_ptr& operator=(std::nullptr_t const) noexcept
+  {
+    reset();
+
+    return *this;
+  }
+
+  bool operator<(intrusive_light_ptr const& rhs) const noexcept
+  {
+    return std::less<T*>()(ptr_, rhs.ptr_);
+  }
+
+  bool operator==(intrusive_light_ptr const& rhs) const noexcept
+  {
+    return ptr_ == rhs.ptr_;
+  }
+
+  bool operator!=(intrusive_light_ptr const& rhs) const noexcept
+  {
+    return !operator==(rhs);
+  }
+
+  bool operator==(std::nullptr_t const) const noexcept { return !ptr_; }
+
+  bool operator!=(std::nullptr_t const) const noexcept { return ptr_; }
+
+  explicit operator bool() const noexcept { return ptr_; }
+
+  T& operator*() const noexcept { return *ptr_; }
+
+  T* operator->() const noexcept { return ptr_; }
+
+  T* get() const noexcept { return ptr_; }
+
+  void reset() noexcept { intrusive_light_ptr().swap(*this); }
+
+  void reset(T* const p) noexcept { intrusive_light_ptr(p).swap(*this); }
+
+  void swap(intrusive_light_ptr& other) noexcept
+  {
+    std::swap(ptr_, other.ptr_);
+  }
+
+  bool unique() const noexcept
+  {
+    return counter_type(1) == use_count();
+  }
+
+  counter_type use_count() const noexcept
+  {
+    return ptr_ ? ptr_->use_count() : counter_type{};
+  }
+};
+
+template <class T, typename ...A>
+inline intrusive_light_ptr<T> make_intrusive_light(A&& ...args)
+{
+  return intrusive_light_ptr<T>(new T(std::forward<A>(args)...));
+}
+
+}
+
+namespace std
+{
+  template <typename T>
+  struct hash<gnr::intrusive_light_ptr<T> >
+  {
+    size_t operator()(gnr::intrusive_light_ptr<T> const& l) const noexcept
+    {
+      return hash<T*>()(l.ptr_);
+    }
+  };
+}
+
+#endif // GNR_INTRUSIVELIGHTPTR_HPP
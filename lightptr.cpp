@@ -1,11 +1,118 @@
+#include <chrono>
+
 #include <iostream>
 
+#include <unordered_set>
+
+#include <vector>
+
 #include "lightptr.hpp"
 
 template <typename U>
 //using ptr_t = std::shared_ptr<U>;
 using ptr_t = gnr::light_ptr<U>;
 
+template <gnr::light_ptr_policy P>
+struct node
+{
+  int value;
+
+  std::vector<gnr::light_ptr<node, P>> children;
+};
+
+// a dag, where node i links to the nodes 2i + 1 and 2i + 2 as well as 3i + 1
+template <gnr::light_ptr_policy P>
+auto make_graph(int const n)
+{
+  std::vector<gnr::light_ptr<node<P>, P>> v;
+
+  for (int i{}; i != n; ++i)
+  {
+    v.push_back(gnr::make_light<node<P>, P>(node<P>{i, {}}));
+  }
+
+  for (int i{}; i != n; ++i)
+  {
+    for (auto const j: {2 * i + 1, 2 * i + 2, 3 * i + 1})
+    {
+      if (j < n)
+      {
+        v[i]->children.push_back(v[j]);
+      }
+      // else do nothing
+    }
+  }
+
+  return v.front();
+}
+
+// depth-first traversals, the stack holds copies of the pointers
+template <gnr::light_ptr_policy P>
+double traverse(char const* const name)
+{
+  auto const root(make_graph<P>(1 << 16));
+
+  auto const start(std::chrono::steady_clock::now());
+
+  long sum{};
+  std::size_t copies{};
+
+  for (int k{}; k != 10; ++k)
+  {
+    std::vector<gnr::light_ptr<node<P>, P>> stack{root};
+
+    while (!stack.empty())
+    {
+      auto const n(stack.back());
+      stack.pop_back();
+
+      sum += n->value;
+
+      for (auto& c: n->children)
+      {
+        // visit a subset, the graph shares nodes
+        if (c->value % 3)
+        {
+          stack.push_back(c);
+
+          ++copies;
+        }
+        // else do nothing
+      }
+    }
+  }
+
+  auto const ns(std::chrono::duration<double, std::nano>(
+    std::chrono::steady_clock::now() - start).count() / copies);
+
+  std::cout << name << ": " << ns << " ns per copy (" << sum << ")" <<
+    std::endl;
+
+  return ns;
+}
+
+// short-lived pointers, created and dropped in a loop
+template <typename F>
+void allocation_rate(char const* const name, F const f)
+{
+  auto const n(10000000);
+
+  auto const start(std::chrono::steady_clock::now());
+
+  long sum{};
+
+  for (int i{}; i != n; ++i)
+  {
+    sum += *f(i);
+  }
+
+  auto const s(std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - start).count());
+
+  std::cout << name << ": " << n / s / 1e6 << " M/s (" << sum << ")" <<
+    std::endl;
+}
+
 int main()
 {
   ptr_t<int> i(new int(10));
@@ -13,5 +120,34 @@ int main()
   *i = 9;
   std::cout << *i << std::endl;
 
+  std::unordered_set<ptr_t<int>> s{i, gnr::make_light<int>(1)};
+  std::cout << s.size() << ' ' << i.use_count() << std::endl;
+
+  traverse<gnr::light_ptr_policy::atomic>("atomic");
+  traverse<gnr::light_ptr_policy::local>("local");
+
+  auto const d([](int* const p) noexcept { delete p; });
+
+  allocation_rate("reset, std::allocator", [&](int const i)
+    {
+      return ptr_t<int>(new int(i), d, std::allocator<int>());
+    }
+  );
+  allocation_rate("reset, pooled", [&](int const i)
+    {
+      return ptr_t<int>(new int(i), d);
+    }
+  );
+  allocation_rate("allocate_light, std::allocator", [](int const i)
+    {
+      return gnr::allocate_light<int>(std::allocator<int>(), i);
+    }
+  );
+  allocation_rate("make_light, pooled", [](int const i)
+    {
+      return gnr::make_light<int>(i);
+    }
+  );
+
   return 0;
 }
@@ -4,14 +4,21 @@
 
 #include <cassert>
 
+// std::size_t
+#include <cstddef>
+
 #include <atomic>
 
 #include <memory>
 
+#include <new>
+
 #include <type_traits>
 
 #include <utility>
 
+#include "blockpool.hpp"
+
 namespace gnr
 {
 
@@ -42,7 +49,93 @@ using ref_type_t = typename ref_type<U>::type;
 
 }
 
-template <typename T>
+enum class light_ptr_policy
+{
+  atomic,
+  // for values, that never cross threads
+  local,
+  // atomic, but elements are destroyed by light_ptr_collect()
+  deferred
+};
+
+namespace detail::light_ptr
+{
+
+struct none
+{
+};
+
+// a control block, whose last strong reference was dropped
+struct retired
+{
+  retired* next;
+
+  void* element;
+
+  void (*reclaim)(retired*) noexcept;
+};
+
+// per-thread list of retired blocks, only touched by its thread
+class retire_list
+{
+  // trivially destructible, so that it is usable during thread exit
+  static inline thread_local retired* head_{};
+
+  struct drain
+  {
+    ~drain() { collect(~std::size_t{}); }
+  };
+
+  static inline thread_local drain drain_;
+
+public:
+  static void retire(retired* const r) noexcept
+  {
+    // register the drain for this thread
+    (void)&drain_;
+
+    r->next = head_;
+    head_ = r;
+  }
+
+  // reclaiming may retire more blocks, they are collected as well
+  static std::size_t collect(std::size_t const n) noexcept
+  {
+    std::size_t i{};
+
+    for (; head_ && (n != i); ++i)
+    {
+      auto const r(head_);
+      head_ = r->next;
+
+      r->reclaim(r);
+    }
+
+    return i;
+  }
+};
+
+}
+
+// reclaims at most n blocks retired by this thread, returns their count
+inline std::size_t light_ptr_collect(std::size_t const n = ~std::size_t{})
+  noexcept
+{
+  return detail::light_ptr::retire_list::collect(n);
+}
+
+template <typename T, light_ptr_policy = light_ptr_policy::atomic>
+class light_ptr;
+
+template <typename T, light_ptr_policy = light_ptr_policy::atomic>
+class light_weak_ptr;
+
+template <typename T, light_ptr_policy P = light_ptr_policy::atomic,
+  typename A, typename ...B
+>
+light_ptr<T, P> allocate_light(A const&, B&& ...);
+
+template <typename T, light_ptr_policy P>
 class light_ptr
 {
   template <typename U, typename V>
@@ -68,16 +161,135 @@ class light_ptr
 
   using element_type = std::remove_extent_t<T>;
 
-  class counter_base
+  class counter_base :
+    public std::conditional_t<light_ptr_policy::deferred == P,
+      detail::light_ptr::retired,
+      detail::light_ptr::none
+    >
   {
     friend class light_ptr;
+    template <typename, light_ptr_policy> friend class light_weak_ptr;
 
+    // destroys the element, or, if passed nullptr, frees the block
     using invoker_type = void (*)(counter_base*, element_type*) noexcept;
 
-    atomic_counter_type counter_{};
+    using count_type = std::conditional_t<light_ptr_policy::local != P,
+      atomic_counter_type,
+      counter_type
+    >;
+
+    count_type counter_{};
+
+    // weak references, plus one while there are strong ones
+    count_type weak_{1};
 
     invoker_type const invoker_;
 
+    // destroys now, or retires for light_ptr_collect()
+    void dispose(element_type* const e) noexcept
+    {
+      if constexpr (light_ptr_policy::deferred == P)
+      {
+        this->element = const_cast<void*>(static_cast<void const*>(e));
+        this->reclaim = [](detail::light_ptr::retired* const r) noexcept
+          {
+            static_cast<counter_base*>(r)->destroy(
+              static_cast<element_type*>(r->element));
+          };
+
+        detail::light_ptr::retire_list::retire(this);
+      }
+      else
+      {
+        destroy(e);
+      }
+    }
+
+    void destroy(element_type* const e) noexcept
+    {
+      invoker_(this, e);
+
+      // skip the atomic operation, if there never were weak references
+      if constexpr (light_ptr_policy::local != P)
+      {
+        if (counter_type(1) == weak_.load(std::memory_order_acquire))
+        {
+          return invoker_(this, nullptr);
+        }
+        // else do nothing
+      }
+      // else do nothing
+
+      dec_weak();
+    }
+
+    void dec_weak() noexcept
+    {
+      if constexpr (light_ptr_policy::local != P)
+      {
+        if (counter_type(1) ==
+          weak_.fetch_sub(counter_type(1), std::memory_order_acq_rel))
+        {
+          invoker_(this, nullptr);
+        }
+        // else do nothing
+      }
+      else if (!--weak_)
+      {
+        invoker_(this, nullptr);
+      }
+      // else do nothing
+    }
+
+    void inc_weak() noexcept
+    {
+      if constexpr (light_ptr_policy::local != P)
+      {
+        weak_.fetch_add(counter_type(1), std::memory_order_relaxed);
+      }
+      else
+      {
+        ++weak_;
+      }
+    }
+
+    // a strong reference, unless the element is gone already
+    bool try_inc_ref() noexcept
+    {
+      if constexpr (light_ptr_policy::local != P)
+      {
+        for (auto c(counter_.load(std::memory_order_relaxed)); c;)
+        {
+          if (counter_.compare_exchange_weak(c, c + 1,
+            std::memory_order_acq_rel, std::memory_order_relaxed))
+          {
+            return true;
+          }
+          // else do nothing
+        }
+
+        return false;
+      }
+      else
+      {
+        return counter_ ? ++counter_, true : false;
+      }
+    }
+
+    // true, if the last reference was dropped
+    bool release() noexcept
+    {
+      if constexpr (light_ptr_policy::local != P)
+      {
+        return counter_type(1) ==
+          counter_.fetch_sub(counter_type(1), std::memory_order_acq_rel);
+      }
+      else
+      {
+        return !--counter_;
+      }
+    }
+
   protected:
     explicit counter_base(counter_type const c,
       invoker_type const invoker) noexcept :
@@ -90,12 +302,11 @@ class light_ptr
     template <typename U>
     std::enable_if_t<!std::is_void<U>{}> dec_ref(U* const ptr) noexcept
     {
-      if (counter_type(1) ==
-        counter_.fetch_sub(counter_type(1), std::memory_order_relaxed))
+      if (release())
       {
         using type_must_be_complete = char[sizeof(U) ? 1 : -1];
         (void)sizeof(type_must_be_complete);
-        invoker_(this, ptr);
+        dispose(ptr);
       }
       // else do nothing
     }
@@ -103,51 +314,139 @@ class light_ptr
     template <typename U>
     std::enable_if_t<std::is_void<U>{}> dec_ref(U* const ptr) noexcept
     {
-      if (counter_type(1) ==
-        counter_.fetch_sub(counter_type(1), std::memory_order_relaxed))
+      if (release())
       {
-        invoker_(this, ptr);
+        dispose(ptr);
       }
       // else do nothing
     }
 
     void inc_ref() noexcept
     {
-      counter_.fetch_add(counter_type(1), std::memory_order_relaxed);
+      if constexpr (light_ptr_policy::local != P)
+      {
+        counter_.fetch_add(counter_type(1), std::memory_order_relaxed);
+      }
+      else
+      {
+        ++counter_;
+      }
+    }
+
+    counter_type use_count() const noexcept
+    {
+      if constexpr (light_ptr_policy::local != P)
+      {
+        return counter_.load(std::memory_order_relaxed);
+      }
+      else
+      {
+        return counter_;
+      }
     }
   };
 
-  template <typename D>
-  class counter : public counter_base
+  // the block comes from A, an empty one takes no space
+  template <typename D, typename A>
+  class counter :
+    public counter_base,
+    std::allocator_traits<A>::template rebind_alloc<counter<D, A>>
   {
+    friend class light_ptr;
+
+    using allocator_type = typename std::allocator_traits<A>::template
+      rebind_alloc<counter>;
+
     std::decay_t<D> const d_;
 
     static void invoked(counter_base* const ptr,
       element_type* const e) noexcept
     {
-      auto const c(static_cast<counter<D>*>(ptr));
+      auto const c(static_cast<counter*>(ptr));
 
-      // invoke deleter on the element
-      c->d_(e);
+      if (e)
+      {
+        // invoke deleter on the element
+        c->d_(e);
+      }
+      else
+      {
+        // free from a static member function
+        allocator_type a(std::move(static_cast<allocator_type&>(*c)));
+
+        c->~counter();
 
-      // delete from a static member function
-      delete c;
+        std::allocator_traits<allocator_type>::deallocate(a, c, 1);
+      }
     }
 
   public:
-    explicit counter(counter_type const c, D&& d) noexcept :
+    explicit counter(counter_type const c, D&& d,
+      allocator_type const& a) noexcept :
       counter_base(c, invoked),
+      allocator_type(a),
       d_(std::forward<D>(d))
     {
     }
   };
 
+  // the object lives in the control block, the deleter is implied by the
+  // type, only the allocator is kept, an empty one takes no space
+  template <typename A>
+  class inplace_counter :
+    public counter_base,
+    std::allocator_traits<A>::template rebind_alloc<inplace_counter<A>>
+  {
+    friend class light_ptr;
+
+    using allocator_type = typename std::allocator_traits<A>::template
+      rebind_alloc<inplace_counter>;
+    using value_allocator_type = typename std::allocator_traits<A>::template
+      rebind_alloc<element_type>;
+
+    std::aligned_storage_t<sizeof(element_type), alignof(element_type)>
+      store_;
+
+    static void invoked(counter_base* const ptr,
+      element_type* const e) noexcept
+    {
+      auto const c(static_cast<inplace_counter*>(ptr));
+
+      if (e)
+      {
+        value_allocator_type va(static_cast<allocator_type&>(*c));
+
+        std::allocator_traits<value_allocator_type>::destroy(va, e);
+      }
+      else
+      {
+        allocator_type a(std::move(static_cast<allocator_type&>(*c)));
+
+        c->~inplace_counter();
+
+        std::allocator_traits<allocator_type>::deallocate(a, c, 1);
+      }
+    }
+
+  public:
+    explicit inplace_counter(allocator_type const& a) noexcept :
+      counter_base(counter_type(1), invoked),
+      allocator_type(a)
+    {
+    }
+  };
+
 private:
   template <typename U> friend struct std::hash;
 
+  template <typename, light_ptr_policy> friend class light_weak_ptr;
+
+  template <typename U, light_ptr_policy Q, typename A, typename ...B>
+  friend light_ptr<U, Q> allocate_light(A const&, B&& ...);
+
   counter_base* counter_{};
 
-  element_type* ptr_;
+  element_type* ptr_{};
 
 public:
   light_ptr() = default;
@@ -164,6 +463,12 @@ public:
     reset(p, std::forward<D>(d));
   }
 
+  template <typename U, typename D, typename A>
+  explicit light_ptr(U* const p, D&& d, A const& a)
+  {
+    reset(p, std::forward<D>(d), a);
+  }
+
   light_ptr(light_ptr const& other) noexcept { *this = other; }
 
   light_ptr(light_ptr&& other) noexcept { *this = std::move(other); }
@@ -202,10 +507,16 @@ public:
 
   light_ptr& operator=(light_ptr&& rhs) noexcept
   {
-    counter_ = rhs.counter_;
-    rhs.counter_ = nullptr;
+    if (this != &rhs)
+    {
+      reset();
+
+      counter_ = rhs.counter_;
+      rhs.counter_ = nullptr;
 
-    ptr_ = rhs.ptr_;
+      ptr_ = rhs.ptr_;
+    }
+    // else do nothing
 
     return *this;
   }
@@ -280,22 +591,96 @@ public:
     );
   }
 
+  // control blocks come from a per-thread pool by default
   template <typename U, typename D>
   void reset(U* const p, D&& d)
   {
-    if (counter_)
+    reset(p, std::forward<D>(d), block_pool_allocator<char>());
+  }
+
+  template <typename U, typename D, typename A>
+  void reset(U* const p, D&& d, A const& a)
+  {
+    counter_base* c{};
+
+    if (p)
     {
-      counter_->dec_ref(ptr_);
+      using counter_t = counter<D, A>;
+      using allocator_type = typename counter_t::allocator_type;
+
+      allocator_type ca(a);
+
+#if defined(__cpp_exceptions)
+      try
+      {
+        c = ::new (std::allocator_traits<allocator_type>::allocate(ca, 1))
+          counter_t(counter_type(1), std::forward<D>(d), ca);
+      }
+      catch (...)
+      {
+        d(p);
+
+        throw;
+      }
+#else
+      c = ::new (std::allocator_traits<allocator_type>::allocate(ca, 1))
+        counter_t(counter_type(1), std::forward<D>(d), ca);
+#endif
     }
     // else do nothing
 
-    counter_ = p ?
-      new counter<D>(counter_type(1), std::forward<D>(d)) :
-      nullptr;
+    reset();
 
+    counter_ = c;
     ptr_ = p;
   }
 
+private:
+  template <typename A, typename ...B>
+  void emplace(A const& a, B&& ...args)
+  {
+    using counter_t = inplace_counter<A>;
+    using allocator_type = typename counter_t::allocator_type;
+    using value_allocator_type = typename counter_t::value_allocator_type;
+
+    allocator_type ca(a);
+
+    auto const c(std::allocator_traits<allocator_type>::allocate(ca, 1));
+
+    ::new (c) counter_t(ca);
+
+    auto const p(reinterpret_cast<element_type*>(&c->store_));
+
+    {
+      value_allocator_type va(ca);
+
+#if defined(__cpp_exceptions)
+      try
+      {
+        std::allocator_traits<value_allocator_type>::construct(va, p,
+          std::forward<B>(args)...);
+      }
+      catch (...)
+      {
+        c->~counter_t();
+
+        std::allocator_traits<allocator_type>::deallocate(ca, c, 1);
+
+        throw;
+      }
+#else
+      std::allocator_traits<value_allocator_type>::construct(va, p,
+        std::forward<B>(args)...);
+#endif
+    }
+
+    reset();
+
+    counter_ = c;
+    ptr_ = p;
+  }
+
+public:
   void swap(light_ptr& other) noexcept
   {
     std::swap(counter_, other.counter_);
@@ -309,29 +694,155 @@ public:
 
   counter_type use_count() const noexcept
   {
-    return counter_ ?
-      counter_->counter_.load(std::memory_order_relaxed) :
-      counter_type{};
+    return counter_ ? counter_->use_count() : counter_type{};
   }
 };
 
-template<class T, typename ...A>
-inline light_ptr<T> make_light(A&& ...args) noexcept(
-  noexcept(new T(std::forward<A>(args)...)))
+// does not keep the element alive, only the control block
+template <typename T, light_ptr_policy P>
+class light_weak_ptr
+{
+  using counter_base = typename light_ptr<T, P>::counter_base;
+
+  using element_type = typename light_ptr<T, P>::element_type;
+
+  counter_base* counter_{};
+
+  element_type* ptr_{};
+
+public:
+  light_weak_ptr() = default;
+
+  light_weak_ptr(light_ptr<T, P> const& p) noexcept :
+    counter_(p.counter_),
+    ptr_(p.ptr_)
+  {
+    if (counter_)
+    {
+      counter_->inc_weak();
+    }
+    // else do nothing
+  }
+
+  light_weak_ptr(light_weak_ptr const& other) noexcept :
+    counter_(other.counter_),
+    ptr_(other.ptr_)
+  {
+    if (counter_)
+    {
+      counter_->inc_weak();
+    }
+    // else do nothing
+  }
+
+  light_weak_ptr(light_weak_ptr&& other) noexcept :
+    counter_(std::exchange(other.counter_, nullptr)),
+    ptr_(other.ptr_)
+  {
+  }
+
+  ~light_weak_ptr() noexcept
+  {
+    if (counter_)
+    {
+      counter_->dec_weak();
+    }
+    // else do nothing
+  }
+
+  light_weak_ptr& operator=(light_weak_ptr const& rhs) noexcept
+  {
+    light_weak_ptr(rhs).swap(*this);
+
+    return *this;
+  }
+
+  light_weak_ptr& operator=(light_weak_ptr&& rhs) noexcept
+  {
+    light_weak_ptr(std::move(rhs)).swap(*this);
+
+    return *this;
+  }
+
+  light_weak_ptr& operator=(light_ptr<T, P> const& rhs) noexcept
+  {
+    light_weak_ptr(rhs).swap(*this);
+
+    return *this;
+  }
+
+  bool expired() const noexcept { return !use_count(); }
+
+  // an empty pointer, if the element is gone
+  light_ptr<T, P> lock() const noexcept
+  {
+    light_ptr<T, P> r;
+
+    if (counter_ && counter_->try_inc_ref())
+    {
+      r.counter_ = counter_;
+      r.ptr_ = ptr_;
+    }
+    // else do nothing
+
+    return r;
+  }
+
+  // orders by control block, like light_ptr
+  bool owner_before(light_weak_ptr const& other) const noexcept
+  {
+    return counter_ < other.counter_;
+  }
+
+  bool owner_before(light_ptr<T, P> const& other) const noexcept
+  {
+    return counter_ < other.counter_;
+  }
+
+  void reset() noexcept { light_weak_ptr().swap(*this); }
+
+  void swap(light_weak_ptr& other) noexcept
+  {
+    std::swap(counter_, other.counter_);
+    std::swap(ptr_, other.ptr_);
+  }
+
+  counter_type use_count() const noexcept
+  {
+    return counter_ ? counter_->use_count() : counter_type{};
+  }
+};
+
+// the object and its control block share one allocation
+template <typename T, light_ptr_policy P, typename A, typename ...B>
+inline light_ptr<T, P> allocate_light(A const& a, B&& ...args)
+{
+  static_assert(!std::is_array<T>{}, "arrays are not supported");
+
+  light_ptr<T, P> r;
+
+  return r.emplace(a, std::forward<B>(args)...), r;
+}
+
+template <class T, light_ptr_policy P = light_ptr_policy::atomic,
+  typename ...A
+>
+inline light_ptr<T, P> make_light(A&& ...args)
 {
-  return light_ptr<T>(new T(std::forward<A>(args)...));
+  return allocate_light<T, P>(block_pool_allocator<T>(),
+    std::forward<A>(args)...);
 }
 
 }
 
 namespace std
 {
-  template <typename T>
-  struct hash<gnr::light_ptr<T> >
+  template <typename T, gnr::light_ptr_policy P>
+  struct hash<gnr::light_ptr<T, P> >
   {
-    size_t operator()(gnr::light_ptr<T> const& l) const noexcept
+    size_t operator()(gnr::light_ptr<T, P> const& l) const noexcept
     {
-      return hash<typename gnr::light_ptr<T>::element_type*>()(l.ptr_);
+      return hash<typename gnr::light_ptr<T, P>::element_type*>()(l.ptr_);
     }
   };
 }
@@ -0,0 +1,87 @@
+// g++ -std=c++17 -pthread lightptrcollect.cpp -o lightptrcollect
+#include <atomic>
+
+#include <cassert>
+
+#include <iostream>
+
+#include <thread>
+
+#include <vector>
+
+#include "lightptr.hpp"
+
+constexpr auto deferred(gnr::light_ptr_policy::deferred);
+
+struct node
+{
+  static inline std::atomic<int> live;
+
+  gnr::light_ptr<node, deferred> next;
+
+  node() noexcept { ++live; }
+
+  ~node() { --live; }
+};
+
+int main()
+{
+  {
+    std::vector<gnr::light_ptr<node, deferred>> v;
+
+    for (int i{}; i != 4; ++i)
+    {
+      v.push_back(gnr::make_light<node, deferred>());
+    }
+
+    v.clear();
+
+    // dropped, but not destroyed yet
+    assert(4 == node::live);
+
+    auto const n(gnr::light_ptr_collect(1));
+
+    assert((1 == n) && (3 == node::live));
+
+    std::cout << "collected " << n << ", " << node::live << " live" <<
+      std::endl;
+
+    gnr::light_ptr_collect();
+
+    assert(!node::live);
+  }
+
+  {
+    // a chain, each reclaimed node retires the next one
+    auto p(gnr::make_light<node, deferred>());
+    p->next = gnr::make_light<node, deferred>();
+    p->next->next = gnr::make_light<node, deferred>();
+
+    p.reset(nullptr);
+
+    assert(3 == node::live);
+
+    auto const n(gnr::light_ptr_collect());
+
+    assert((3 == n) && !node::live);
+
+    std::cout << "chain: collected " << n << ", " << node::live << " live" <<
+      std::endl;
+  }
+
+  {
+    // a thread's retired blocks are collected, when it exits
+    std::thread([]
+      {
+        auto const p(gnr::make_light<node, deferred>());
+        auto const q(gnr::make_light<node, deferred>());
+      }
+    ).join();
+
+    assert(!node::live);
+
+    std::cout << "thread exit: " << node::live << " live" << std::endl;
+  }
+
+  return 0;
+}
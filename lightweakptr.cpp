@@ -0,0 +1,60 @@
+// g++ -std=c++17 lightweakptr.cpp -o lightweakptr
+#include <cassert>
+
+#include <iostream>
+
+#include "lightptr.hpp"
+
+struct node
+{
+  static inline int live;
+
+  int value;
+
+  explicit node(int const v) noexcept : value(v) { ++live; }
+
+  ~node() { --live; }
+};
+
+template <gnr::light_ptr_policy P, typename F>
+void expire(char const* const name, F const make)
+{
+  gnr::light_weak_ptr<node, P> w;
+
+  assert(w.expired() && !w.lock());
+
+  {
+    auto const p(make());
+
+    w = p;
+
+    auto const q(w.lock());
+
+    assert(q && (p == q) && (2 == w.use_count()));
+
+    std::cout << name << ": locked " << q->value << ", " << w.use_count() <<
+      " owners" << std::endl;
+  }
+
+  // the element is gone, the control block stays for w
+  assert(w.expired() && !w.lock() && !node::live);
+
+  std::cout << name << ": expired " << w.expired() << ", lock " <<
+    bool(w.lock()) << std::endl;
+}
+
+int main()
+{
+  // the element in its own allocation
+  expire<gnr::light_ptr_policy::atomic>("atomic",
+    []{ return gnr::light_ptr<node>(new node(1)); });
+
+  // the element shares the allocation with the control block
+  expire<gnr::light_ptr_policy::atomic>("atomic, make_light",
+    []{ return gnr::make_light<node>(2); });
+
+  expire<gnr::light_ptr_policy::local>("local, make_light",
+    []{ return gnr::make_light<node, gnr::light_ptr_policy::local>(3); });
+
+  return 0;
+}
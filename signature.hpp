@@ -0,0 +1,314 @@
+#ifndef GNR_SIGNATURE_HPP
+# define GNR_SIGNATURE_HPP
+# pragma once
+
+namespace gnr
+{
+
+namespace detail
+{
+
+template <typename>
+struct signature
+{
+};
+
+//
+template <typename>
+struct class_ref;
+
+//
+template <typename R, typename C, typename ...A>
+struct class_ref<R (C::*)(A...)>
+{
+  using type = C&;
+};
+
+template <typename R, typename C, typename ...A>
+struct class_ref<R (C::*)(A...) const>
+{
+  using type = C const&;
+};
+
+template <typename R, typename C, typename ...A>
+struct class_ref<R (C::*)(A...) const volatile>
+{
+  using type = C const volatile&;
+};
+
+//
+template <typename R, typename C, typename ...A>
+struct class_ref<R (C::*)(A...) &>
+{
+  using type = C&;
+};
+
+template <typename R, typename C, typename ...A>
+struct class_ref<R (C::*)(A...) const &>
+{
+  using type = C const&;
+};
+
+template <typename R, typename C, typename ...A>
+struct class_ref<R (C::*)(A...) const volatile &>
+{
+  using type = C const volatile&;
+};
+
+//
+template <typename R, typename C, typename ...A>
+struct class_ref<R (C::*)(A...) &&>
+{
+  using type = C&&;
+};
+
+template <typename R, typename C, typename ...A>
+struct class_ref<R (C::*)(A...) const &&>
+{
+  using type = C const&&;
+};
+
+template <typename R, typename C, typename ...A>
+struct class_ref<R (C::*)(A...) const volatile &&>
+{
+  using type = C const volatile&&;
+};
+
+//
+template <typename R, typename C, typename ...A>
+struct class_ref<R (C::*)(A...) noexcept>
+{
+  using type = C&;
+};
+
+template <typename R, typename C, typename ...A>
+struct class_ref<R (C::*)(A...) const noexcept>
+{
+  using type = C const&;
+};
+
+template <typename R, typename C, typename ...A>
+struct class_ref<R (C::*)(A...) const volatile noexcept>
+{
+  using type = C const volatile&;
+};
+
+//
+template <typename R, typename C, typename ...A>
+struct class_ref<R (C::*)(A...) & noexcept>
+{
+  using type = C&;
+};
+
+template <typename R, typename C, typename ...A>
+struct class_ref<R (C::*)(A...) const & noexcept>
+{
+  using type = C const&;
+};
+
+template <typename R, typename C, typename ...A>
+struct class_ref<R (C::*)(A...) const volatile & noexcept>
+{
+  using type = C const volatile&;
+};
+
+//
+template <typename R, typename C, typename ...A>
+struct class_ref<R (C::*)(A...) && noexcept>
+{
+  using type = C&&;
+};
+
+template <typename R, typename C, typename ...A>
+struct class_ref<R (C::*)(A...) const && noexcept>
+{
+  using type = C const &&;
+};
+
+template <typename R, typename C, typename ...A>
+struct class_ref<R (C::*)(A...) const volatile && noexcept>
+{
+  using type = C const volatile &&;
+};
+
+template <typename F>
+using class_ref_t = typename class_ref<F>::type;
+
+//
+template <typename>
+struct remove_cv_seq;
+
+//
+template <typename R, typename ...A>
+struct remove_cv_seq<R(A...)>
+{
+  using type = R(A...);
+};
+
+template <typename R, typename ...A>
+struct remove_cv_seq<R(A...) const>
+{
+  using type = R(A...);
+};
+
+template <typename R, typename ...A>
+struct remove_cv_seq<R(A...) volatile>
+{
+  using type = R(A...);
+};
+
+template <typename R, typename ...A>
+struct remove_cv_seq<R(A...) const volatile>
+{
+  using type = R(A...);
+};
+
+//
+template <typename R, typename ...A>
+struct remove_cv_seq<R(A...) noexcept>
+{
+  using type = R(A...);
+};
+
+template <typename R, typename ...A>
+struct remove_cv_seq<R(A...) const noexcept>
+{
+  using type = R(A...);
+};
+
+template <typename R, typename ...A>
+struct remove_cv_seq<R(A...) volatile noexcept>
+{
+  using type = R(A...);
+};
+
+template <typename R, typename ...A>
+struct remove_cv_seq<R(A...) const volatile noexcept>
+{
+  using type = R(A...);
+};
+
+//
+template <typename R, typename ...A>
+struct remove_cv_seq<R(A...) &>
+{
+  using type = R(A...);
+};
+
+template <typename R, typename ...A>
+struct remove_cv_seq<R(A...) const &>
+{
+  using type = R(A...);
+};
+
+template <typename R, typename ...A>
+struct remove_cv_seq<R(A...) volatile &>
+{
+  using type = R(A...);
+};
+
+template <typename R, typename ...A>
+struct remove_cv_seq<R(A...) const volatile &>
+{
+  using type = R(A...);
+};
+
+//
+template <typename R, typename ...A>
+struct remove_cv_seq<R(A...) & noexcept>
+{
+  using type = R(A...);
+};
+
+template <typename R, typename ...A>
+struct remove_cv_seq<R(A...) const & noexcept >
+{
+  using type = R(A...);
+};
+
+template <typename R, typename ...A>
+struct remove_cv_seq<R(A...) volatile & noexcept>
+{
+  using type = R(A...);
+};
+
+template <typename R, typename ...A>
+struct remove_cv_seq<R(A...) const volatile & noexcept>
+{
+  using type = R(A...);
+};
+
+//
+template <typename R, typename ...A>
+struct remove_cv_seq<R(A...) &&>
+{
+  using type = R(A...);
+};
+
+template <typename R, typename ...A>
+struct remove_cv_seq<R(A...) const &&>
+{
+  using type = R(A...);
+};
+
+template <typename R, typename ...A>
+struct remove_cv_seq<R(A...) volatile &&>
+{
+  using type = R(A...);
+};
+
+template <typename R, typename ...A>
+struct remove_cv_seq<R(A...) const volatile &&>
+{
+  using type = R(A...);
+};
+
+//
+template <typename R, typename ...A>
+struct remove_cv_seq<R(A...) && noexcept>
+{
+  using type = R(A...);
+};
+
+template <typename R, typename ...A>
+struct remove_cv_seq<R(A...) const && noexcept>
+{
+  using type = R(A...);
+};
+
+template <typename R, typename ...A>
+struct remove_cv_seq<R(A...) volatile && noexcept>
+{
+  using type = R(A...);
+};
+
+template <typename R, typename ...A>
+struct remove_cv_seq<R(A...) const volatile && noexcept>
+{
+  using type = R(A...);
+};
+
+template <typename F>
+constexpr auto extract_signature(F* const) noexcept
+{
+  return signature<typename remove_cv_seq<F>::type>();
+}
+
+template <typename C, typename F>
+constexpr auto extract_signature(F C::* const) noexcept
+{
+  return signature<typename remove_cv_seq<F>::type>();
+}
+
+template <typename F>
+constexpr auto extract_signature(F const&) noexcept ->
+  decltype(&F::operator(), extract_signature(&F::operator()))
+{
+  return extract_signature(&F::operator());
+}
+
+}
+
+}
+
+#endif // GNR_SIGNATURE_HPP
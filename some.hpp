@@ -4,6 +4,11 @@
 
 #include <cassert>
 
+// std::max_align_t
+#include <cstddef>
+
+#include <memory>
+
 #include <ostream>
 
 #include <type_traits>
@@ -12,18 +17,164 @@
 
 #include <utility>
 
+#include "blockpool.hpp"
+
+#include "signature.hpp"
+
 namespace gnr
 {
 
+template <std::size_t, typename ...>
+class some;
+
+class some_vector;
+
+template <typename ...F>
+struct overloaded : F...
+{
+  using F::operator()...;
+};
+
+template <typename ...F>
+overloaded(F...) -> overloaded<F...>;
+
+// types that may be moved by copying their bytes and forgetting the
+// source, specialize for such types that are not trivially copyable
+template <typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T>
+{
+};
+
 namespace detail
 {
 
 namespace some
 {
 
+template <typename>
+struct is_open_some : std::false_type
+{
+};
+
+template <std::size_t N>
+struct is_open_some<gnr::some<N>> : std::true_type
+{
+};
+
 template <typename T>
 using remove_cvr_t = std::remove_cv_t<std::remove_reference_t<T>>;
 
+template <typename T>
+struct type_tag
+{
+  using type = T;
+};
+
+// 1-based position of U in T..., 0 if absent
+template <typename U, typename ...T>
+constexpr std::size_t index_of() noexcept
+{
+  constexpr bool const same[]{std::is_same<U, T>{}...};
+
+  for (std::size_t i{}; i != sizeof...(T); ++i)
+  {
+    if (same[i])
+    {
+      return i + 1;
+    }
+    // else do nothing
+  }
+
+  return 0;
+}
+
+// calls f with the type tag of the i-th type, compilers lower the chain of
+// compares into a jump table
+template <typename ...T, typename F, std::size_t ...I>
+inline void select(std::size_t const i, F&& f, std::index_sequence<I...>)
+{
+  (void)((I + 1 == i ? (f(type_tag<T>{}), true) : false) || ...);
+}
+
+template <typename ...T, typename F>
+inline void select(std::size_t const i, F&& f)
+{
+  select<T...>(i, std::forward<F>(f), std::index_sequence_for<T...>());
+}
+
+// the store of a closed set some, trivially destructible if all of T are
+template <std::size_t N, bool, typename ...T>
+struct closed_store
+{
+  typename std::aligned_storage<N>::type store_;
+
+  // 0 when empty, otherwise the 1-based position of the type
+  unsigned char index_{};
+
+  void destroy() noexcept
+  {
+    select<T...>(index_, [&](auto const t) noexcept
+      {
+        using value_type = typename decltype(t)::type;
+
+        reinterpret_cast<value_type*>(&store_)->~value_type();
+      }
+    );
+  }
+
+  ~closed_store() { destroy(); }
+};
+
+template <std::size_t N, typename ...T>
+struct closed_store<N, true, T...>
+{
+  typename std::aligned_storage<N>::type store_;
+
+  unsigned char index_{};
+
+  void destroy() noexcept
+  {
+  }
+};
+
+template <std::size_t N, typename ...T>
+using closed_store_t = closed_store<N,
+  (std::is_trivially_destructible_v<T> && ...), T...>;
+
+template <typename ...T>
+struct type_list
+{
+};
+
+template <typename>
+struct first_argument;
+
+template <typename R, typename A, typename ...B>
+struct first_argument<signature<R(A, B...)>>
+{
+  using type = remove_cvr_t<A>;
+};
+
+template <typename F>
+using first_argument_t = typename first_argument<
+  decltype(detail::extract_signature(std::declval<F const&>()))>::type;
+
+// the types a visitor handles, one per non-generic overload
+template <typename F>
+struct candidates
+{
+  using type = type_list<first_argument_t<F>>;
+};
+
+template <typename ...F>
+struct candidates<overloaded<F...>>
+{
+  using type = type_list<first_argument_t<F>...>;
+};
+
+template <typename F>
+using candidates_t = typename candidates<F>::type;
+
 template <bool B>
 using bool_constant = std::integral_constant<bool, B>;
 
@@ -45,12 +196,14 @@ struct is_vector : std::false_type
 template <typename T>
 struct is_vector<T,
   decltype(
-    sizeof((typename T::reference(T::*)())(&T::back)) |
-    sizeof((typename T::reference(T::*)())(&T::front)) |
-    sizeof((typename T::value_type const*(T::*)() const)(&T::data)) |
-    sizeof((typename T::value_type*(T::*)())(&T::data)) |
-    sizeof((void(T::*)(typename T::const_reference))(&T::push_back)) |
-    sizeof((void(T::*)(typename T::value_type&&))(&T::push_back)) |
+    sizeof(static_cast<typename T::reference(T::*)()>(&T::back)) |
+    sizeof(static_cast<typename T::reference(T::*)()>(&T::front)) |
+    sizeof(static_cast<typename T::value_type const*(T::*)() const>(
+      &T::data)) |
+    sizeof(static_cast<typename T::value_type*(T::*)()>(&T::data)) |
+    sizeof(static_cast<void(T::*)(typename T::const_reference)>(
+      &T::push_back)) |
+    sizeof(static_cast<void(T::*)(typename T::value_type&&)>(&T::push_back)) |
     sizeof(&T::shrink_to_fit)
   )
 > : std::true_type
@@ -65,8 +218,9 @@ struct is_list : std::false_type
 template <typename T>
 struct is_list<T,
   decltype(
-    sizeof((void(T::*)(typename T::const_reference))(&T::push_front)) |
-    sizeof((void(T::*)(typename T::value_type&&))(&T::push_front)) |
+    sizeof(static_cast<void(T::*)(typename T::const_reference)>(
+      &T::push_front)) |
+    sizeof(static_cast<void(T::*)(typename T::value_type&&)>(&T::push_front)) |
     sizeof(&T::pop_front)
   )
 > : std::true_type
@@ -194,24 +348,97 @@ struct is_move_or_copy_constructible :
 {
 };
 
+// objects that do not fit the store are kept in a pooled block, whose
+// pointer is in the store
+template <typename U, bool S>
+inline U* object(void* const store) noexcept
+{
+  if constexpr (S)
+  {
+    return *static_cast<U**>(store);
+  }
+  else
+  {
+    return static_cast<U*>(store);
+  }
+}
+
+template <typename U, bool S>
+inline U const* object(void const* const store) noexcept
+{
+  if constexpr (S)
+  {
+    return *static_cast<U const* const*>(store);
+  }
+  else
+  {
+    return static_cast<U const*>(store);
+  }
+}
+
+template <typename U, bool S, typename ...A>
+inline void construct(void* const store, A&& ...args)
+{
+  if constexpr (S)
+  {
+    static_assert(alignof(U) <= alignof(std::max_align_t),
+      "type overaligned");
+
+    using pool = block_pool<sizeof(U)>;
+
+    auto const p(pool::allocate());
+
+#if defined(__cpp_exceptions)
+    try
+    {
+      *static_cast<U**>(store) = ::new (p) U(std::forward<A>(args)...);
+    }
+    catch (...)
+    {
+      pool::deallocate(p);
+
+      throw;
+    }
+#else
+    *static_cast<U**>(store) = ::new (p) U(std::forward<A>(args)...);
+#endif
+  }
+  else
+  {
+    ::new (store) U(std::forward<A>(args)...);
+  }
+}
+
 using deleter_type = void (*)(void*);
 using copier_type = void (*)(bool, deleter_type, void*, void const*);
 using mover_type = void (*)(bool, deleter_type, void*, void*);
 
-template <class U>
+// construct into an empty store from an object, for cross-size assignment
+using copy_constructor_type = void (*)(void*, void const*);
+using move_constructor_type = void (*)(void*, void*);
+
+template <class U, bool S>
 typename std::enable_if_t<!std::is_void<U>{}>
 deleter_stub(void* const store)
 {
-  reinterpret_cast<U*>(store)->~U();
+  auto const p(object<U, S>(store));
+
+  p->~U();
+
+  if constexpr (S)
+  {
+    block_pool<sizeof(U)>::deallocate(p);
+  }
+  // else do nothing
 }
 
-template <class U>
+template <class U, bool S>
 typename std::enable_if_t<std::is_void<U>{}>
 deleter_stub(void* const)
 {
 }
 
-template <typename U>
+template <typename U, bool S>
 typename std::enable_if_t<
   is_copy_constructible<U>{} &&
   is_copy_assignable<U>{}
@@ -221,18 +448,17 @@ copier_stub(bool const same_type, deleter_type const deleter,
 {
   if (same_type)
   {
-    *reinterpret_cast<U*>(dst_store) =
-      *reinterpret_cast<U const*>(src_store);
+    *object<U, S>(dst_store) = *object<U, S>(src_store);
   }
   else
   {
     deleter(dst_store);
 
-    new (dst_store) U(*reinterpret_cast<U const*>(src_store));
+    construct<U, S>(dst_store, *object<U, S>(src_store));
   }
 }
 
-template <typename U>
+template <typename U, bool S>
 typename std::enable_if_t<
   is_copy_constructible<U>{} &&
   !is_copy_assignable<U>{}
@@ -242,10 +468,10 @@ copier_stub(bool const, deleter_type const deleter,
 {
   deleter(dst_store);
 
-  new (dst_store) U(*reinterpret_cast<U const*>(src_store));
+  construct<U, S>(dst_store, *object<U, S>(src_store));
 }
 
-template <typename U>
+template <typename U, bool S>
 typename std::enable_if_t<
   is_move_constructible<U>{} &&
   is_move_assignable<U>{}
@@ -255,18 +481,17 @@ mover_stub(bool const same_type, deleter_type const deleter,
 {
   if (same_type)
   {
-    *reinterpret_cast<U*>(dst_store) =
-      std::move(*reinterpret_cast<U*>(src_store));
+    *object<U, S>(dst_store) = std::move(*object<U, S>(src_store));
   }
   else
   {
     deleter(dst_store);
 
-    new (dst_store) U(std::move(*reinterpret_cast<U*>(src_store)));
+    construct<U, S>(dst_store, std::move(*object<U, S>(src_store)));
   }
 }
 
-template <typename U>
+template <typename U, bool S>
 typename std::enable_if_t<
   is_move_constructible<U>{} &&
   !is_move_assignable<U>{}
@@ -276,35 +501,124 @@ mover_stub(bool const, deleter_type const deleter,
 {
   deleter(dst_store);
 
-  new (dst_store) U(std::move(*reinterpret_cast<U*>(src_store)));
+  construct<U, S>(dst_store, std::move(*object<U, S>(src_store)));
 }
 
-template <class U>
+template <typename U, bool S>
+void copy_constructor_stub(void* const dst_store, void const* const src)
+{
+  construct<U, S>(dst_store, *static_cast<U const*>(src));
+}
+
+template <typename U, bool S>
+void move_constructor_stub(void* const dst_store, void* const src)
+{
+  construct<U, S>(dst_store, std::move(*static_cast<U*>(src)));
+}
+
+template <class U, bool S>
 constexpr inline std::enable_if_t<!is_copy_constructible<U>{}, copier_type>
 get_copier() noexcept
 {
   return nullptr;
 }
 
-template <class U>
+template <class U, bool S>
 constexpr inline std::enable_if_t<is_copy_constructible<U>{}, copier_type>
 get_copier() noexcept
 {
-  return copier_stub<U>;
+  return copier_stub<U, S>;
 }
 
-template <class U>
+template <class U, bool S>
 constexpr inline std::enable_if_t<!is_move_constructible<U>{}, mover_type>
 get_mover() noexcept
 {
   return nullptr;
 }
 
-template <class U>
+template <class U, bool S>
 constexpr inline std::enable_if_t<is_move_constructible<U>{}, mover_type>
 get_mover() noexcept
 {
-  return mover_stub<U>;
+  return mover_stub<U, S>;
+}
+
+template <class U, bool S>
+constexpr inline copy_constructor_type get_copy_constructor() noexcept
+{
+  if constexpr (is_copy_constructible<U>{})
+  {
+    return copy_constructor_stub<U, S>;
+  }
+  else
+  {
+    return nullptr;
+  }
+}
+
+template <class U, bool S>
+constexpr inline move_constructor_type get_move_constructor() noexcept
+{
+  if constexpr (is_move_constructible<U>{})
+  {
+    return move_constructor_stub<U, S>;
+  }
+  else
+  {
+    return nullptr;
+  }
+}
+
+// for arrays of objects, used by some_vector
+using array_copier_type = void (*)(void*, void const*, std::size_t);
+using array_mover_type = void (*)(void*, void*, std::size_t);
+using array_deleter_type = void (*)(void*, std::size_t);
+
+template <typename U>
+void array_copier_stub(void* const dst, void const* const src,
+  std::size_t const n)
+{
+  std::uninitialized_copy_n(static_cast<U const*>(src), n,
+    static_cast<U*>(dst));
+}
+
+template <typename U>
+void array_mover_stub(void* const dst, void* const src, std::size_t const n)
+{
+  std::uninitialized_move_n(static_cast<U*>(src), n, static_cast<U*>(dst));
+}
+
+template <typename U>
+void array_deleter_stub(void* const p, std::size_t const n)
+{
+  std::destroy_n(static_cast<U*>(p), n);
+}
+
+template <class U>
+constexpr inline array_copier_type get_array_copier() noexcept
+{
+  if constexpr (is_copy_constructible<U>{})
+  {
+    return array_copier_stub<U>;
+  }
+  else
+  {
+    return nullptr;
+  }
+}
+
+template <class U>
+constexpr inline array_mover_type get_array_mover() noexcept
+{
+  if constexpr (is_move_constructible<U>{})
+  {
+    return array_mover_stub<U>;
+  }
+  else
+  {
+    return nullptr;
+  }
 }
 
 using typeid_t = void(*)();
@@ -318,38 +632,105 @@ struct meta
   std::size_t size;
 
   typeid_t type_id;
+
+  std::size_t align;
+
+  bool spilled;
+
+  bool nothrow_movable;
+
+  // a move is a copy of the store
+  bool relocatable;
+
+  // the same type, stored the other way
+  struct meta const* (*other)();
+
+  copy_constructor_type copy_constructor;
+  move_constructor_type move_constructor;
+
+  array_copier_type array_copier;
+  array_mover_type array_mover;
+  array_deleter_type array_deleter;
+
+  void const* object(void const* const store) const noexcept
+  {
+    return spilled ? *static_cast<void const* const*>(store) : store;
+  }
+
+  void* object(void* const store) const noexcept
+  {
+    return spilled ? *static_cast<void**>(store) : store;
+  }
 };
 
-template <typename U>
+template <typename U, bool S = false>
 std::enable_if_t<!std::is_void<U>{}, struct meta const*>
 get_meta()
 {
   static struct meta const m{
-    get_copier<U>(),
-    get_mover<U>(),
-    deleter_stub<U>,
+    get_copier<U, S>(),
+    get_mover<U, S>(),
+    deleter_stub<U, S>,
     sizeof(U),
-    typeid_t(get_meta<U>)
+    typeid_t(get_meta<U>),
+    alignof(U),
+    S,
+    std::is_nothrow_move_constructible<U>{},
+    S || is_trivially_relocatable<U>{},
+    get_meta<U, !S>,
+    get_copy_constructor<U, S>(),
+    get_move_constructor<U, S>(),
+    get_array_copier<U>(),
+    get_array_mover<U>(),
+    array_deleter_stub<U>
   };
 
   return &m;
 }
 
-template <typename U>
+template <typename U, bool S = false>
 std::enable_if_t<std::is_void<U>{}, struct meta const*>
 get_meta()
 {
   static struct meta const m{
-    get_copier<U>(),
-    get_mover<U>(),
-    deleter_stub<U>,
+    get_copier<U, S>(),
+    get_mover<U, S>(),
+    deleter_stub<U, S>,
+    0,
+    typeid_t(get_meta<U>),
     0,
-    typeid_t(get_meta<U>)
+    false,
+    true,
+    true,
+    get_meta<U>,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr
   };
 
   return &m;
 }
 
+// the metas are compared against link-time constants, so that a mismatch
+// is resolved as soon as the meta pointer of s is loaded
+template <typename ...T, typename S, typename F>
+inline bool visit(S& s, F&& f)
+{
+  using some_type = std::remove_const_t<S>;
+
+  return ((get_meta<T, some_type::template is_spilled<T>()>() == s.meta_ ?
+    (f(*object<T, some_type::template is_spilled<T>()>(&s.store_)), true) :
+    false) || ...);
+}
+
+template <typename S, typename F, typename ...T>
+inline bool visit(S& s, F&& f, type_list<T...>)
+{
+  return visit<T...>(s, std::forward<F>(f));
+}
+
 }
 
 }
@@ -359,10 +740,11 @@ get_meta()
 # pragma GCC diagnostic ignored "-Wstrict-aliasing"
 #endif // __GNUC__
 
-template <std::size_t N>
+// some<N> holds any type, some<N, T...> only the listed ones
+template <std::size_t N, typename ...T>
 class some
 {
-  template <std::size_t M>
+  template <std::size_t, typename ...>
   friend class some;
 
 public:
@@ -374,7 +756,13 @@ public:
 
   some(some const& other) { *this = other; }
 
-  some(some&& other) { *this = std::move(other); }
+  some(some&& other) noexcept { *this = std::move(other); }
+
+  template <std::size_t M>
+  some(some<M> const& other) { *this = other; }
+
+  template <std::size_t M>
+  some(some<M>&& other) { *this = std::move(other); }
 
   some& operator=(some const& rhs)
   {
@@ -406,28 +794,24 @@ public:
   template <std::size_t M>
   some& operator=(some<M> const& rhs)
   {
-    if (this != &rhs)
+    if (!rhs)
     {
-      if (!rhs)
-      {
-        clear();
-      }
-      else if ((rhs.meta_->copier_) &&
-        (rhs.meta_->size <= sizeof(store_)))
-      {
-        rhs.meta_->copier(meta_ == rhs.meta_,
-          meta_->deleter, &store_, &rhs.store_);
+      clear();
+    }
+    else if (auto const m(variant(rhs.meta_)); m->copy_constructor)
+    {
+      clear();
 
-        meta_ = rhs.meta_;
-      }
-      else
-      {
+      m->copy_constructor(&store_, rhs.meta_->object(&rhs.store_));
+
+      meta_ = m;
+    }
+    else
+    {
 #if defined(__cpp_exceptions)
-        throw std::bad_typeid();
+      throw std::bad_typeid();
 #endif
-      }
     }
-    // else do nothing
 
     return *this;
   }
@@ -440,6 +824,12 @@ public:
       {
         clear();
       }
+      else if (rhs.meta_->relocatable)
+      {
+        clear();
+
+        relocate(rhs);
+      }
       else if (rhs.meta_->mover)
       {
         rhs.meta_->mover(meta_ == rhs.meta_,
@@ -462,28 +852,36 @@ public:
   template <std::size_t M>
   some& operator=(some<M>&& rhs)
   {
-    if (this != &rhs)
+    if (!rhs)
     {
-      if (!rhs)
-      {
-        clear();
-      }
-      else if ((rhs.mover_) &&
-        (rhs.meta_->size <= sizeof(store_)))
-      {
-        rhs.meta_.mover(meta_ == rhs.meta_,
-          meta_->deleter, &store_, &rhs.store_);
+      clear();
+    }
+    else if (auto const m(variant(rhs.meta_));
+      (m == rhs.meta_) && m->spilled)
+    {
+      // both spilled, the block changes hands
+      clear();
 
-        meta_ = rhs.meta_;
-      }
-      else
-      {
+      *reinterpret_cast<void**>(&store_) =
+        *reinterpret_cast<void**>(&rhs.store_);
+
+      meta_ = m;
+      rhs.meta_ = detail::some::get_meta<void>();
+    }
+    else if (m->move_constructor)
+    {
+      clear();
+
+      m->move_constructor(&store_, rhs.meta_->object(&rhs.store_));
+
+      meta_ = m;
+    }
+    else
+    {
 #if defined(__cpp_exceptions)
-        throw std::bad_typeid();
+      throw std::bad_typeid();
 #endif
-      }
     }
-    // else do nothing
 
     return *this;
   }
@@ -492,7 +890,7 @@ public:
     typename U,
     typename = std::enable_if_t<
       !std::is_array<detail::some::remove_cvr_t<U>>{} &&
-      !std::is_same<std::decay_t<U>, some>{}
+      !detail::some::is_open_some<std::decay_t<U>>{}
     >
   >
   some(U&& f)
@@ -507,7 +905,7 @@ public:
 
   template <typename U,
     typename = std::enable_if_t<
-      !std::is_same<std::decay_t<U>, some>{}
+      !detail::some::is_open_some<std::decay_t<U>>{}
     >
   >
   some& operator=(U&& u)
@@ -527,19 +925,19 @@ public:
   assign(U&& u)
   {
     using user_type = std::decay_t<U>;
-    static_assert(sizeof(user_type) <= sizeof(store_), "");
+    constexpr auto s(is_spilled<user_type>());
 
-    if (detail::some::get_meta<user_type>() == meta_)
+    if (detail::some::get_meta<user_type, s>() == meta_)
     {
-      *reinterpret_cast<user_type*>(&store_) = std::forward<U>(u);
+      *detail::some::object<user_type, s>(&store_) = std::forward<U>(u);
     }
     else
     {
       clear();
 
-      new (static_cast<void*>(&store_)) user_type(std::forward<U>(u));
+      detail::some::construct<user_type, s>(&store_, std::forward<U>(u));
 
-      meta_ = detail::some::get_meta<user_type>();
+      meta_ = detail::some::get_meta<user_type, s>();
     }
 
     return *this;
@@ -557,19 +955,19 @@ public:
   assign(U&& u)
   {
     using user_type = std::decay_t<U>;
-    static_assert(sizeof(user_type) <= sizeof(store_), "");
+    constexpr auto s(is_spilled<user_type>());
 
-    if (detail::some::get_meta<user_type>() == meta_)
+    if (detail::some::get_meta<user_type, s>() == meta_)
     {
-      *reinterpret_cast<user_type*>(&store_) = std::move(u);
+      *detail::some::object<user_type, s>(&store_) = std::move(u);
     }
     else
     {
       clear();
 
-      new (static_cast<void*>(&store_)) user_type(std::forward<U>(u));
+      detail::some::construct<user_type, s>(&store_, std::forward<U>(u));
 
-      meta_ = detail::some::get_meta<user_type>();
+      meta_ = detail::some::get_meta<user_type, s>();
     }
 
     return *this;
@@ -586,13 +984,13 @@ public:
   assign(U&& u)
   {
     using user_type = std::decay_t<U>;
-    static_assert(sizeof(user_type) <= sizeof(store_), "");
+    constexpr auto s(is_spilled<user_type>());
 
     clear();
 
-    new (static_cast<void*>(&store_)) user_type(std::forward<U>(u));
+    detail::some::construct<user_type, s>(&store_, std::forward<U>(u));
 
-    meta_ = detail::some::get_meta<user_type>();
+    meta_ = detail::some::get_meta<user_type, s>();
 
     return *this;
   }
@@ -608,7 +1006,15 @@ public:
 
   void swap(some& other)
   {
-    if (detail::some::get_meta<void>() == other.meta_)
+    if (meta_->relocatable && other.meta_->relocatable)
+    {
+      auto const tmp(store_);
+      store_ = other.store_;
+      other.store_ = tmp;
+
+      std::swap(meta_, other.meta_);
+    }
+    else if (detail::some::get_meta<void>() == other.meta_)
     {
       if (meta_->mover)
       {
@@ -675,7 +1081,7 @@ public:
   template <typename U>
   static typeid_t type_id() noexcept
   {
-    return typeid_t(detail::some::get_meta<U>());
+    return typeid_t(detail::some::get_meta<U>);
   }
 
   typeid_t type_id() const noexcept { return meta_->type_id; }
@@ -683,18 +1089,376 @@ public:
 private:
   template <typename U, std::size_t M> friend bool contains(some<M> const&) noexcept;
 
+  template <typename ...U, typename S, typename F>
+  friend bool detail::some::visit(S&, F&&);
+
+  friend class some_vector;
+
   template <typename U, std::size_t M> friend U& std::get(some<M>&);
   template <typename U, std::size_t M> friend U const& std::get(some<M> const&);
 
   struct detail::some::meta const* meta_{detail::some::get_meta<void>()};
 
   typename std::aligned_storage<N>::type store_;
+
+  // types that do not fit are spilled into a pooled block, as are types
+  // that may throw on move, so that moving a some cannot throw
+  template <typename U>
+  static constexpr bool is_spilled() noexcept
+  {
+    return (sizeof(U) > sizeof(store_)) ||
+      (alignof(U) > alignof(decltype(store_))) ||
+      !std::is_nothrow_move_constructible<U>{};
+  }
+
+  // the meta of m's type, as it is stored in this some
+  static auto variant(struct detail::some::meta const* const m) noexcept
+  {
+    return (m->size > sizeof(store_)) ||
+      (m->align > alignof(decltype(store_))) || !m->nothrow_movable ?
+      (m->spilled ? m : m->other()) :
+      (m->spilled ? m->other() : m);
+  }
+
+  // requires an empty some, rhs is left empty
+  void relocate(some& rhs) noexcept
+  {
+    store_ = rhs.store_;
+    meta_ = rhs.meta_;
+
+    rhs.meta_ = detail::some::get_meta<void>();
+  }
 };
 
 template <typename U, std::size_t N>
 inline bool contains(some<N> const& s) noexcept
 {
-  return detail::some::get_meta<std::decay_t<U>>() == s.meta_;
+  using user_type = std::decay_t<U>;
+
+  return detail::some::get_meta<user_type,
+    some<N>::template is_spilled<user_type>()>() == s.meta_;
+}
+
+template <std::size_t N>
+inline void swap(some<N>& a, some<N>& b)
+{
+  a.swap(b);
+}
+
+template <std::size_t N, typename T, typename ...U>
+class some<N, T, U...> : detail::some::closed_store_t<N, T, U...>
+{
+  template <std::size_t, typename ...>
+  friend class some;
+
+  using inherited_t = detail::some::closed_store_t<N, T, U...>;
+
+  using inherited_t::store_;
+  using inherited_t::index_;
+
+  static_assert(sizeof...(U) < 255, "too many types");
+  static_assert((sizeof(T) <= N) && ((sizeof(U) <= N) && ...),
+    "type too large");
+  static_assert((alignof(T) <= alignof(decltype(store_))) &&
+    ((alignof(U) <= alignof(decltype(store_))) && ...),
+    "type overaligned");
+
+public:
+  using typeid_t = detail::some::typeid_t;
+
+private:
+  template <typename V, std::size_t M, typename W, typename ...X>
+  friend bool contains(some<M, W, X...> const&) noexcept;
+
+  template <typename V, std::size_t M, typename W, typename ...X>
+  friend V& std::get(some<M, W, X...>&);
+  template <typename V, std::size_t M, typename W, typename ...X>
+  friend V const& std::get(some<M, W, X...> const&);
+
+  template <typename F, std::size_t M, typename W, typename ...X>
+  friend bool visit(some<M, W, X...>&, F&&);
+  template <typename F, std::size_t M, typename W, typename ...X>
+  friend bool visit(some<M, W, X...> const&, F&&);
+
+  template <typename V>
+  static constexpr auto index_of() noexcept
+  {
+    return static_cast<unsigned char>(
+      detail::some::index_of<V, T, U...>());
+  }
+
+  template <typename V, typename S>
+  static decltype(auto) value(S&& s) noexcept
+  {
+    using value_type = std::conditional_t<
+      std::is_const<std::remove_reference_t<S>>{}, V const, V>;
+
+    if constexpr (std::is_lvalue_reference<S>{})
+    {
+      return *reinterpret_cast<value_type*>(&s.store_);
+    }
+    else
+    {
+      return std::move(*reinterpret_cast<value_type*>(&s.store_));
+    }
+  }
+
+  template <typename S>
+  void construct(S&& other)
+  {
+    detail::some::select<T, U...>(other.index_, [&](auto const t)
+      {
+        using value_type = typename decltype(t)::type;
+
+        if constexpr (std::is_constructible<value_type,
+          decltype(value<value_type>(std::forward<S>(other)))>{})
+        {
+          ::new (static_cast<void*>(&this->store_)) value_type(
+            value<value_type>(std::forward<S>(other)));
+
+          this->index_ = other.index_;
+        }
+        else
+        {
+#if defined(__cpp_exceptions)
+          throw std::bad_typeid();
+#endif
+        }
+      }
+    );
+  }
+
+  template <typename S>
+  void transfer(S&& rhs)
+  {
+    if (index_ == rhs.index_)
+    {
+      detail::some::select<T, U...>(index_, [&](auto const t)
+        {
+          using value_type = typename decltype(t)::type;
+
+          if constexpr (std::is_assignable<value_type&,
+            decltype(value<value_type>(std::forward<S>(rhs)))>{})
+          {
+            value<value_type>(*this) =
+              value<value_type>(std::forward<S>(rhs));
+          }
+          else
+          {
+            clear();
+            construct(std::forward<S>(rhs));
+          }
+        }
+      );
+    }
+    else
+    {
+      clear();
+      construct(std::forward<S>(rhs));
+    }
+  }
+
+public:
+  some() = default;
+
+  some(some const& other) { construct(other); }
+
+  some(some&& other) noexcept(
+    std::is_nothrow_move_constructible_v<T> &&
+    (std::is_nothrow_move_constructible_v<U> && ...))
+  {
+    construct(std::move(other));
+  }
+
+  template <
+    typename V,
+    typename = std::enable_if_t<
+      !std::is_array<detail::some::remove_cvr_t<V>>{} &&
+      !std::is_same<std::decay_t<V>, some>{}
+    >
+  >
+  some(V&& v)
+  {
+    assign(std::forward<V>(v));
+  }
+
+  some& operator=(some const& rhs)
+  {
+    if (this != &rhs)
+    {
+      transfer(rhs);
+    }
+    // else do nothing
+
+    return *this;
+  }
+
+  some& operator=(some&& rhs)
+  {
+    if (this != &rhs)
+    {
+      transfer(std::move(rhs));
+    }
+    // else do nothing
+
+    return *this;
+  }
+
+  template <typename V,
+    typename = std::enable_if_t<
+      !std::is_same<std::decay_t<V>, some>{}
+    >
+  >
+  some& operator=(V&& v)
+  {
+    return assign(std::forward<V>(v));
+  }
+
+  explicit operator bool() const noexcept { return index_; }
+
+  template <typename V>
+  some& assign(V&& v)
+  {
+    using user_type = std::decay_t<V>;
+
+    constexpr auto i(index_of<user_type>());
+    static_assert(i, "type not in the type list");
+
+    if constexpr (std::is_assignable<user_type&, V&&>{})
+    {
+      if (i == index_)
+      {
+        value<user_type>(*this) = std::forward<V>(v);
+
+        return *this;
+      }
+      // else do nothing
+    }
+
+    clear();
+
+    ::new (static_cast<void*>(&store_)) user_type(std::forward<V>(v));
+
+    index_ = i;
+
+    return *this;
+  }
+
+  void clear() noexcept
+  {
+    inherited_t::destroy();
+
+    index_ = {};
+  }
+
+  bool empty() const noexcept { return !*this; }
+
+  void swap(some& other)
+  {
+    if (index_ == other.index_)
+    {
+      detail::some::select<T, U...>(index_, [&](auto const t)
+        {
+          using std::swap;
+
+          using value_type = typename decltype(t)::type;
+
+          swap(value<value_type>(*this), value<value_type>(other));
+        }
+      );
+    }
+    else
+    {
+      some tmp(std::move(other));
+
+      other = std::move(*this);
+      *this = std::move(tmp);
+    }
+  }
+
+  template <typename V>
+  static typeid_t type_id() noexcept
+  {
+    return typeid_t(detail::some::get_meta<V>);
+  }
+
+  typeid_t type_id() const noexcept
+  {
+    static typeid_t const ids[]{
+      type_id<void>(),
+      type_id<T>(),
+      type_id<U>()...
+    };
+
+    return ids[index_];
+  }
+};
+
+template <typename U, std::size_t N, typename T, typename ...V>
+inline bool contains(some<N, T, V...> const& s) noexcept
+{
+  constexpr auto i(some<N, T, V...>::template index_of<std::decay_t<U>>());
+
+  return i && (i == s.index_);
+}
+
+// calls f with the contained value if its type is one of T..., or when T...
+// is empty, one of the types taken by the overloads of f; false otherwise
+template <typename ...T, std::size_t N, typename F>
+inline bool visit(some<N>& s, F&& f)
+{
+  if constexpr (bool(sizeof...(T)))
+  {
+    return detail::some::visit<T...>(s, std::forward<F>(f));
+  }
+  else
+  {
+    return detail::some::visit(s, std::forward<F>(f),
+      detail::some::candidates_t<std::decay_t<F>>());
+  }
+}
+
+template <typename ...T, std::size_t N, typename F>
+inline bool visit(some<N> const& s, F&& f)
+{
+  if constexpr (bool(sizeof...(T)))
+  {
+    return detail::some::visit<T...>(s, std::forward<F>(f));
+  }
+  else
+  {
+    return detail::some::visit(s, std::forward<F>(f),
+      detail::some::candidates_t<std::decay_t<F>>());
+  }
+}
+
+// calls f with the contained value, false if s is empty
+template <typename F, std::size_t N, typename T, typename ...U>
+inline bool visit(some<N, T, U...>& s, F&& f)
+{
+  detail::some::select<T, U...>(s.index_, [&](auto const t)
+    {
+      using value_type = typename decltype(t)::type;
+
+      f(some<N, T, U...>::template value<value_type>(s));
+    }
+  );
+
+  return bool(s);
+}
+
+template <typename F, std::size_t N, typename T, typename ...U>
+inline bool visit(some<N, T, U...> const& s, F&& f)
+{
+  detail::some::select<T, U...>(s.index_, [&](auto const t)
+    {
+      using value_type = typename decltype(t)::type;
+
+      f(some<N, T, U...>::template value<value_type>(s));
+    }
+  );
+
+  return bool(s);
 }
 
 #ifdef __GNUC__
@@ -714,14 +1478,16 @@ inline U& get(gnr::some<N>& s)
 #if defined(__cpp_exceptions)
   if (gnr::contains<nonref>(s))
   {
-    return *reinterpret_cast<nonref*>(&s.store_);
+    return *gnr::detail::some::object<nonref,
+      gnr::some<N>::template is_spilled<nonref>()>(&s.store_);
   }
   else
   {
     throw std::bad_cast();
   }
 #else
-  return *reinterpret_cast<nonref*>(&s.store_);
+  return *gnr::detail::some::object<nonref,
+    gnr::some<N>::template is_spilled<nonref>()>(&s.store_);
 #endif
 }
 
@@ -733,15 +1499,49 @@ inline U const& get(gnr::some<N> const& s)
 #if defined(__cpp_exceptions)
   if (gnr::contains<nonref>(s))
   {
-    return *reinterpret_cast<nonref const*>(&s.store_);
+    return *gnr::detail::some::object<nonref,
+      gnr::some<N>::template is_spilled<nonref>()>(&s.store_);
   }
   else
   {
     throw std::bad_cast();
   }
 #else
-  return *reinterpret_cast<nonref const*>(&s.store_);
+  return *gnr::detail::some::object<nonref,
+    gnr::some<N>::template is_spilled<nonref>()>(&s.store_);
+#endif
+}
+
+template <typename U, std::size_t N, typename T, typename ...V>
+inline U& get(gnr::some<N, T, V...>& s)
+{
+  using nonref = gnr::detail::some::remove_cvr_t<U>;
+
+#if defined(__cpp_exceptions)
+  if (!gnr::contains<nonref>(s))
+  {
+    throw std::bad_cast();
+  }
+  // else do nothing
 #endif
+
+  return *reinterpret_cast<nonref*>(&s.store_);
+}
+
+template <typename U, std::size_t N, typename T, typename ...V>
+inline U const& get(gnr::some<N, T, V...> const& s)
+{
+  using nonref = gnr::detail::some::remove_cvr_t<U>;
+
+#if defined(__cpp_exceptions)
+  if (!gnr::contains<nonref>(s))
+  {
+    throw std::bad_cast();
+  }
+  // else do nothing
+#endif
+
+  return *reinterpret_cast<nonref const*>(&s.store_);
 }
 
 }
@@ -0,0 +1,343 @@
+#ifndef GNR_SOMEVECTOR_HPP
+# define GNR_SOMEVECTOR_HPP
+# pragma once
+
+// std::size_t
+#include <cstddef>
+
+#include <new>
+
+#include <type_traits>
+
+#include <typeinfo>
+
+#include <utility>
+
+#include <vector>
+
+#include "some.hpp"
+
+namespace gnr
+{
+
+// values are grouped by type into contiguous runs, so that bulk copy and
+// destruction cost one indirect call per type and visitation none at all;
+// insertion order is kept within a type only
+class some_vector
+{
+  struct run
+  {
+    struct detail::some::meta const* meta;
+
+    void* data;
+
+    std::size_t size;
+    std::size_t capacity;
+  };
+
+  std::vector<run> runs_;
+
+  std::size_t size_{};
+
+  // the inline meta identifies a type
+  static auto key(struct detail::some::meta const* const m) noexcept
+  {
+    return m->spilled ? m->other() : m;
+  }
+
+  run const* find(struct detail::some::meta const* const m) const noexcept
+  {
+    for (auto& r: runs_)
+    {
+      if (m == r.meta)
+      {
+        return &r;
+      }
+      // else do nothing
+    }
+
+    return nullptr;
+  }
+
+  run& find_or_add(struct detail::some::meta const* const m)
+  {
+    if (auto const r(find(m)); r)
+    {
+      return const_cast<run&>(*r);
+    }
+    else
+    {
+      return runs_.push_back({m, nullptr, 0, 0}), runs_.back();
+    }
+  }
+
+  // returns the address past the last element, growing the run if full
+  static void* back(run& r)
+  {
+    auto const m(r.meta);
+
+    if (r.size == r.capacity)
+    {
+      auto const capacity(r.capacity ? 2 * r.capacity : 4);
+
+      auto const p(::operator new(capacity * m->size));
+
+      if (r.size)
+      {
+#if defined(__cpp_exceptions)
+        try
+        {
+          m->array_mover(p, r.data, r.size);
+        }
+        catch (...)
+        {
+          ::operator delete(p);
+
+          throw;
+        }
+#else
+        m->array_mover(p, r.data, r.size);
+#endif
+
+        m->array_deleter(r.data, r.size);
+      }
+      // else do nothing
+
+      ::operator delete(r.data);
+
+      r.data = p;
+      r.capacity = capacity;
+    }
+    // else do nothing
+
+    return static_cast<char*>(r.data) + r.size * m->size;
+  }
+
+public:
+  some_vector() = default;
+
+  // delegates, so that a throwing copier leaves a destructible object
+  some_vector(some_vector const& other) : some_vector()
+  {
+    runs_.reserve(other.runs_.size());
+
+    for (auto& r: other.runs_)
+    {
+      auto const m(r.meta);
+
+      if (!m->array_copier)
+      {
+#if defined(__cpp_exceptions)
+        throw std::bad_typeid();
+#else
+        continue;
+#endif
+      }
+      // else do nothing
+
+      runs_.push_back({m, ::operator new(r.size * m->size), 0, r.size});
+
+      auto& n(runs_.back());
+
+      m->array_copier(n.data, r.data, r.size);
+
+      n.size = r.size;
+      size_ += r.size;
+    }
+  }
+
+  some_vector(some_vector&& other) noexcept :
+    runs_(std::exchange(other.runs_, {})),
+    size_(std::exchange(other.size_, 0))
+  {
+  }
+
+  ~some_vector() { clear(); }
+
+  some_vector& operator=(some_vector const& rhs)
+  {
+    if (this != &rhs)
+    {
+      some_vector tmp(rhs);
+
+      swap(tmp);
+    }
+    // else do nothing
+
+    return *this;
+  }
+
+  some_vector& operator=(some_vector&& rhs) noexcept
+  {
+    if (this != &rhs)
+    {
+      clear();
+
+      runs_ = std::exchange(rhs.runs_, {});
+      size_ = std::exchange(rhs.size_, 0);
+    }
+    // else do nothing
+
+    return *this;
+  }
+
+  template <typename U, typename ...A>
+  U& emplace_back(A&& ...args)
+  {
+    static_assert(alignof(U) <= alignof(std::max_align_t),
+      "type overaligned");
+    static_assert(std::is_move_constructible_v<U>,
+      "type not move constructible");
+
+    auto& r(find_or_add(detail::some::get_meta<U>()));
+
+    auto const p(::new (back(r)) U(std::forward<A>(args)...));
+
+    ++r.size;
+    ++size_;
+
+    return *p;
+  }
+
+  template <typename U,
+    typename = std::enable_if_t<
+      !detail::some::is_open_some<std::decay_t<U>>{}
+    >
+  >
+  void push_back(U&& u)
+  {
+    emplace_back<std::decay_t<U>>(std::forward<U>(u));
+  }
+
+  // copies the value of s, if any
+  template <std::size_t N>
+  void push_back(some<N> const& s)
+  {
+    if (s)
+    {
+      auto const m(key(s.meta_));
+
+      if (!m->array_copier)
+      {
+#if defined(__cpp_exceptions)
+        throw std::bad_typeid();
+#else
+        return;
+#endif
+      }
+      // else do nothing
+
+      auto& r(find_or_add(m));
+
+      m->array_copier(back(r), s.meta_->object(&s.store_), 1);
+
+      ++r.size;
+      ++size_;
+    }
+    // else do nothing
+  }
+
+  void clear() noexcept
+  {
+    for (auto& r: runs_)
+    {
+      r.meta->array_deleter(r.data, r.size);
+
+      ::operator delete(r.data);
+    }
+
+    runs_.clear();
+
+    size_ = {};
+  }
+
+  bool empty() const noexcept { return !size_; }
+
+  std::size_t size() const noexcept { return size_; }
+
+  void swap(some_vector& other) noexcept
+  {
+    runs_.swap(other.runs_);
+    std::swap(size_, other.size_);
+  }
+
+  template <typename U>
+  std::size_t count() const noexcept
+  {
+    auto const r(find(detail::some::get_meta<U>()));
+
+    return r ? r->size : 0;
+  }
+
+  // the values of type U, in insertion order
+  template <typename U>
+  U* data() noexcept
+  {
+    auto const r(find(detail::some::get_meta<U>()));
+
+    return r ? static_cast<U*>(r->data) : nullptr;
+  }
+
+  template <typename U>
+  U const* data() const noexcept
+  {
+    auto const r(find(detail::some::get_meta<U>()));
+
+    return r ? static_cast<U const*>(r->data) : nullptr;
+  }
+
+  // calls f with every value of type T..., or when T... is empty, of the
+  // types taken by the overloads of f
+  template <typename ...T, typename F>
+  void visit(F&& f)
+  {
+    visit_runs<T...>(*this, f);
+  }
+
+  template <typename ...T, typename F>
+  void visit(F&& f) const
+  {
+    visit_runs<T...>(*this, f);
+  }
+
+private:
+  // S is some_vector or some_vector const, the values take on its const
+  template <typename ...T, typename S, typename F>
+  static void visit_runs(S& s, F& f)
+  {
+    if constexpr (bool(sizeof...(T)))
+    {
+      for (auto& r: s.runs_)
+      {
+        (void)((detail::some::get_meta<std::remove_cv_t<T>>() == r.meta ?
+          (visit_run<std::conditional_t<std::is_const<S>{}, T const, T>>(
+            r, f), true) : false) || ...);
+      }
+    }
+    else
+    {
+      visit_runs(s, f, detail::some::candidates_t<std::decay_t<F>>());
+    }
+  }
+
+  template <typename S, typename F, typename ...T>
+  static void visit_runs(S& s, F& f, detail::some::type_list<T...>)
+  {
+    visit_runs<T...>(s, f);
+  }
+
+  template <typename U, typename F>
+  static void visit_run(run const& r, F& f)
+  {
+    auto const p(static_cast<U*>(r.data));
+
+    for (auto i(p), end(p + r.size); end != i; ++i)
+    {
+      f(*i);
+    }
+  }
+};
+
+}
+
+#endif // GNR_SOMEVECTOR_HPP